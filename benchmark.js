@@ -1,6 +1,14 @@
 var Crypto = require('crypto');
+var FS = require('fs');
+var OS = require('os');
+var Path = require('path');
 var Quorum = require('./index.js');
 
+// node benchmark.js [--json]
+// With --json, results are written to stdout as a single JSON document, with
+// one record per line of the report, so that releases can be compared.
+var JSON_OUTPUT = process.argv.indexOf('--json') !== -1;
+
 var objects = 1000;
 var vectorOffset = 0;
 var objectSize = Quorum.VECTOR;
@@ -20,14 +28,157 @@ function ns(time, runs) {
   );
 }
 
-console.log('');
-console.log('  ' + require('os').cpus()[0].model);
-console.log('');
-console.log('                NS PER OBJECT');
-console.log('');
+// Returns the fastest of several runs, in nanoseconds per unit of work:
+function fastest(repeat, units, method) {
+  var best = Infinity;
+  for (var run = 0; run < repeat; run++) {
+    var time = process.hrtime();
+    method();
+    var elapsed = process.hrtime(time);
+    best = Math.min(best, ((elapsed[0] * 1e9) + elapsed[1]) / units);
+  }
+  return Math.round(best);
+}
+
+var Report = {
+  cpu: OS.cpus()[0].model,
+  cpus: OS.cpus().length,
+  section: null,
+  records: []
+};
+
+Report.header = function(section) {
+  var self = this;
+  self.section = section;
+  if (JSON_OUTPUT) return;
+  console.log('                ' + section);
+  console.log('');
+};
+
+// Each field is [KEY, value, unit, width], e.g. ['FAST', 41, 'ns', 7]:
+Report.row = function(fields) {
+  var self = this;
+  var record = { section: self.section };
+  var line = '';
+  fields.forEach(
+    function(field) {
+      record[field[0].toLowerCase()] = field[1];
+      var text = field[0] + '=' + field[1] + (field[2] || '');
+      if (field[3]) text = text.padEnd(field[0].length + 1 + field[3]);
+      line += ' ' + text;
+    }
+  );
+  self.records.push(record);
+  if (!JSON_OUTPUT) console.log(' ' + line.trimEnd());
+};
+
+Report.footer = function() {
+  if (!JSON_OUTPUT) console.log('');
+};
+
+Report.end = function() {
+  var self = this;
+  if (!JSON_OUTPUT) return;
+  console.log(
+    JSON.stringify(
+      {
+        cpu: self.cpu,
+        cpus: self.cpus,
+        node: process.version,
+        records: self.records
+      },
+      null,
+      2
+    )
+  );
+};
+
+// Replicas with a realistic mix of divergence, one object at a time:
+//
+// AGREE    All replicas have the same vector.
+// LAGGING  One or two replicas lag the leader by one update.
+// CHAINS   A minority of replicas have an unrelated vector.
+// FORKED   Two chains of the same length (split-brain).
+var Scenario = {};
+
+Scenario.sources = function(length, size, objects, mix) {
+  var sources = [];
+  for (var index = 0; index < length; index++) {
+    sources.push(Buffer.alloc(objects * size));
+  }
+  var ids = Crypto.randomBytes(objects * Quorum.ID * 5);
+  for (var object = 0; object < objects; object++) {
+    var offset = object * size;
+    var id = [];
+    for (var index = 0; index < 5; index++) {
+      var idOffset = (object * 5 + index) * Quorum.ID;
+      id.push(ids.slice(idOffset, idOffset + Quorum.ID));
+    }
+    var leader = Buffer.concat([id[0], id[1]]);
+    var lagging = Buffer.concat([id[1], id[2]]);
+    var unrelated = Buffer.concat([id[3], id[4]]);
+    var third = Buffer.concat([id[2], id[1]]);
+    var kind = Scenario.choose(mix);
+    var half = Math.floor(length / 2);
+    for (var index = 0; index < length; index++) {
+      var vector = leader;
+      if (kind === 'lagging' && index < Math.min(2, length - 1)) {
+        vector = lagging;
+      } else if (kind === 'chains' && index < Math.floor((length - 1) / 2)) {
+        vector = unrelated;
+      } else if (kind === 'forked' && index < half) {
+        vector = unrelated;
+      } else if (kind === 'forked' && index >= half * 2) {
+        // An odd replica out, so that the two chains are the same length:
+        vector = third;
+      }
+      vector.copy(sources[index], offset);
+    }
+  }
+  return sources;
+};
+
+// mix is a map of kind to fraction, with the remainder of objects in AGREE:
+Scenario.choose = function(mix) {
+  var random = Math.random();
+  for (var kind in mix) {
+    if (random < mix[kind]) return kind;
+    random -= mix[kind];
+  }
+  return 'agree';
+};
+
+Scenario.calculate = function(sources, size, objects, options) {
+  Quorum.calculate(
+    0,
+    size,
+    0,
+    objects * size,
+    sources,
+    Buffer.alloc(objects * Quorum.SIZE),
+    0,
+    null,
+    0,
+    options
+  );
+};
+
+if (!JSON_OUTPUT) {
+  console.log('');
+  console.log('  ' + Report.cpu);
+  console.log('');
+}
+Report.header('NS PER OBJECT');
 
+var lengths = [];
 for (var length = 1; length <= Quorum.SOURCES_MAX; length *= 2) {
-  
+  lengths.push(length);
+}
+// Include the widest replica set, where the slow path is most expensive:
+lengths.push(Quorum.SOURCES_MAX);
+
+lengths.forEach(function(length) {
+
   // Fast path:
   var sources = [];
   for (var index = 0; index < length; index++) {
@@ -73,10 +224,484 @@ for (var length = 1; length <= Quorum.SOURCES_MAX; length *= 2) {
   var slow = ns(time, runs);
   if (slow < fast) slow = fast;
 
-  console.log(
-    '  REPLICAS=' + length.toString().padEnd(4, ' ') +
-    ' FAST=' + (fast + 'ns').padEnd(7, ' ') +
-    ' SLOW=' + (slow + 'ns')
-  );
+  Report.row([
+    ['REPLICAS', length, '', 4],
+    ['FAST', fast, 'ns', 7],
+    ['SLOW', slow, 'ns']
+  ]);
+});
+Report.footer();
+
+// Realistic divergence, where most objects agree and a few do not:
+Report.header('NS PER OBJECT BY SCENARIO');
+[
+  ['AGREE', {}],
+  ['LAGGING=1%', { lagging: 0.01 }],
+  ['LAGGING=10%', { lagging: 0.1 }],
+  ['LAGGING=50%', { lagging: 0.5 }],
+  ['CHAINS=10%', { chains: 0.1 }],
+  ['FORKED=10%', { forked: 0.1 }],
+  ['MIXED', { lagging: 0.05, chains: 0.01, forked: 0.01 }]
+].forEach(function(scenario) {
+  var fields = [['SCENARIO', scenario[0], '', 12]];
+  [3, 5, 16].forEach(function(length) {
+    var sources = Scenario.sources(length, objectSize, objects, scenario[1]);
+    var time = fastest(10, objects, function() {
+      Scenario.calculate(sources, objectSize, objects);
+    });
+    fields.push(['R' + length, time, 'ns', 7]);
+  });
+  Report.row(fields);
+});
+Report.footer();
+
+// Threads, for a region large enough to be spread across them:
+Report.header('NS PER OBJECT BY THREADS (16 REPLICAS, LAGGING=10%)');
+(function() {
+  var count = 262144;
+  var sources = Scenario.sources(16, objectSize, count, { lagging: 0.1 });
+  [1, 2, 4, 8, 16].forEach(function(threads) {
+    var time = fastest(3, count, function() {
+      Scenario.calculate(sources, objectSize, count, { threads: threads });
+    });
+    Report.row([
+      ['THREADS', threads, '', 3],
+      ['CALCULATE', time, 'ns']
+    ]);
+  });
+})();
+Report.footer();
+
+// Many small extents, one call each or one batch for all:
+Report.header('NS PER EXTENT');
+[1, 4, 16].forEach(function(length) {
+  var count = Math.floor(objects / length);
+  var extents = Buffer.alloc(count * Quorum.EXTENT);
+  for (var index = 0; index < count; index++) {
+    var offset = index * Quorum.EXTENT;
+    extents.writeUInt32LE(index * length * objectSize, offset + 0);
+    extents.writeUInt32LE(length * objectSize, offset + 8);
+    extents.writeUInt32LE(index * length * Quorum.SIZE, offset + 16);
+    extents.writeUInt32LE(index * length * objectSize, offset + 24);
+  }
+  var sources = [a, a, b];
+  var runs = 100;
+  var time = process.hrtime();
+  for (var run = 0; run < runs; run++) {
+    for (var index = 0; index < count; index++) {
+      Quorum.calculate(
+        vectorOffset,
+        objectSize,
+        index * length * objectSize,
+        length * objectSize,
+        sources,
+        quorum,
+        index * length * Quorum.SIZE,
+        target,
+        index * length * objectSize
+      );
+    }
+  }
+  var elapsed = process.hrtime(time);
+  var single = Math.round(((elapsed[0] * 1e9) + elapsed[1]) / runs / count);
+  var time = process.hrtime();
+  for (var run = 0; run < runs; run++) {
+    Quorum.calculateBatch(
+      vectorOffset,
+      objectSize,
+      sources,
+      extents,
+      quorum,
+      target
+    );
+  }
+  var elapsed = process.hrtime(time);
+  var batch = Math.round(((elapsed[0] * 1e9) + elapsed[1]) / runs / count);
+  Report.row([
+    ['OBJECTS', length, '', 5],
+    ['CALCULATE', single, 'ns', 7],
+    ['BATCH', batch, 'ns']
+  ]);
+});
+Report.footer();
+
+// Small calls to many replicas, with and without a ReplicaSet:
+Report.header('NS PER CALL (1 OBJECT)');
+[16, 64, Quorum.SOURCES_MAX].forEach(function(length) {
+  var sources = [];
+  for (var index = 0; index < length; index++) sources.push(index % 3 ? a : b);
+  var replicaSet = new Quorum.ReplicaSet(sources);
+  var runs = 20000;
+  var time = process.hrtime();
+  for (var run = 0; run < runs; run++) {
+    Quorum.calculate(
+      vectorOffset,
+      objectSize,
+      sourceOffset,
+      objectSize,
+      sources,
+      quorum,
+      quorumOffset,
+      target,
+      targetOffset
+    );
+  }
+  var elapsed = process.hrtime(time);
+  var single = Math.round(((elapsed[0] * 1e9) + elapsed[1]) / runs);
+  var time = process.hrtime();
+  for (var run = 0; run < runs; run++) {
+    replicaSet.calculate(
+      vectorOffset,
+      objectSize,
+      sourceOffset,
+      objectSize,
+      quorum,
+      quorumOffset,
+      target,
+      targetOffset
+    );
+  }
+  var elapsed = process.hrtime(time);
+  var pinned = Math.round(((elapsed[0] * 1e9) + elapsed[1]) / runs);
+  Report.row([
+    ['REPLICAS', length, '', 4],
+    ['CALCULATE', single, 'ns', 8],
+    ['REPLICASET', pinned, 'ns']
+  ]);
+});
+Report.footer();
+
+// Objects of each size, with each vector read at the object stride, either in
+// place (DIRECT) or gathered into a vector table (STREAM). The object count is
+// fixed and the sources are sparse (only the page of each vector is touched),
+// so that every size reads the same number of vectors. A buffer larger than
+// the last level cache is written before each run so that the vectors are not
+// in cache, and runs alternate between the two paths, reporting the median:
+Report.header('NS PER OBJECT BY SIZE (16 REPLICAS, NOT IN CACHE)');
+(function() {
+  var count = 2048;
+  var runs = 31;
+  var evict = Buffer.alloc(256 * 1024 * 1024);
+  function run(sources, size, stream, fill) {
+    evict.fill(fill);
+    var time = process.hrtime();
+    Scenario.calculate(sources, size, count, { stream: stream });
+    var elapsed = process.hrtime(time);
+    return ((elapsed[0] * 1e9) + elapsed[1]) / count;
+  }
+  function median(values) {
+    values.sort(function(a, b) { return a - b; });
+    return Math.round(values[values.length >> 1]);
+  }
+  [32, 512, 4096, 65536].forEach(function(size) {
+    var vectors = Crypto.randomBytes(count * Quorum.VECTOR);
+    var sources = [];
+    for (var index = 0; index < 16; index++) {
+      var source = Buffer.alloc(count * size);
+      for (var object = 0; object < count; object++) {
+        vectors.copy(
+          source,
+          object * size,
+          object * Quorum.VECTOR,
+          (object + 1) * Quorum.VECTOR
+        );
+      }
+      sources.push(source);
+    }
+    var direct = [];
+    var stream = [];
+    for (var fill = 0; fill < runs; fill++) {
+      direct.push(run(sources, size, false, fill));
+      stream.push(run(sources, size, true, fill));
+    }
+    Report.row([
+      ['SIZE', size, '', 6],
+      ['DIRECT', median(direct), 'ns', 7],
+      ['STREAM', median(stream), 'ns']
+    ]);
+  });
+})();
+Report.footer();
+
+// One transaction ID applied to many vectors, one call each or in one call:
+Report.header('NS PER VECTOR (UPDATE)');
+(function() {
+  var source = Crypto.randomBytes(sourceSize);
+  var id = Crypto.randomBytes(Quorum.ID);
+  var runs = 100;
+  var time = process.hrtime();
+  for (var run = 0; run < runs; run++) {
+    id[0]++;
+    for (var index = 0; index < objects; index++) {
+      Quorum.update(source, index * objectSize + vectorOffset, id);
+    }
+  }
+  var update = ns(time, runs);
+  var time = process.hrtime();
+  for (var run = 0; run < runs; run++) {
+    id[0]++;
+    Quorum.updateMany(vectorOffset, objectSize, 0, sourceSize, source, id);
+  }
+  var updateMany = ns(time, runs);
+  Report.row([
+    ['OBJECTS', objects, '', 5],
+    ['UPDATE', update, 'ns', 7],
+    ['UPDATEMANY', updateMany, 'ns']
+  ]);
+})();
+Report.footer();
+
+// Scrubs of unchanged objects, with and without a cache of fingerprints:
+Report.header('NS PER OBJECT (UNCHANGED)');
+[4, 16, 64].forEach(function(length) {
+  var sources = [];
+  for (var index = 0; index < length; index++) {
+    sources.push(Crypto.randomBytes(sourceSize));
+  }
+  var cache = Buffer.alloc(objects * Quorum.CACHE);
+  var uncached = fastest(10, objects, function() {
+    Scenario.calculate(sources, objectSize, objects, {});
+  });
+  // The quorum buffer must persist across calls for the cache:
+  var cachedQuorum = Buffer.alloc(objects * Quorum.SIZE);
+  var cached = fastest(10, objects, function() {
+    Quorum.calculate(
+      vectorOffset,
+      objectSize,
+      sourceOffset,
+      sourceSize,
+      sources,
+      cachedQuorum,
+      quorumOffset,
+      null,
+      targetOffset,
+      { cache: cache }
+    );
+  });
+  Report.row([
+    ['REPLICAS', length, '', 4],
+    ['CALCULATE', uncached, 'ns', 8],
+    ['CACHE', cached, 'ns']
+  ]);
+});
+Report.footer();
+
+// Scrubs which only need the objects which are not unanimous, by scanning
+// every quorum result in JS, or with options.sparse:
+Report.header('NS PER OBJECT (SPARSE, LAGGING=1%)');
+[3, 16].forEach(function(length) {
+  var count = 65536;
+  var sources = Scenario.sources(length, objectSize, count, { lagging: 0.01 });
+  var scanQuorum = Buffer.alloc(count * Quorum.SIZE);
+  var found = [];
+  var scan = fastest(5, count, function() {
+    Quorum.calculate(
+      0,
+      objectSize,
+      0,
+      count * objectSize,
+      sources,
+      scanQuorum,
+      0,
+      null,
+      0
+    );
+    found.length = 0;
+    for (var object = 0; object < count; object++) {
+      var offset = object * Quorum.SIZE;
+      if (
+        scanQuorum[offset + Quorum.LENGTH_OFFSET] !== length ||
+        scanQuorum[offset + Quorum.REPAIR_OFFSET] !== 0
+      ) {
+        found.push(object);
+      }
+    }
+  });
+  var entries = Buffer.alloc(count * Quorum.SPARSE);
+  var sparse = fastest(5, count, function() {
+    var entriesLength = Quorum.calculate(
+      0,
+      objectSize,
+      0,
+      count * objectSize,
+      sources,
+      null,
+      0,
+      null,
+      0,
+      { sparse: entries }
+    );
+    found.length = 0;
+    for (var index = 0; index < entriesLength; index++) {
+      found.push(entries.readUInt32LE(index * Quorum.SPARSE));
+    }
+  });
+  Report.row([
+    ['REPLICAS', length, '', 4],
+    ['SCAN', scan, 'ns', 6],
+    ['SPARSE', sparse, 'ns']
+  ]);
+});
+Report.footer();
+
+// More replicas than SOURCES_MAX, with calculateWide(), where LAGGING and
+// CHAINS diverge for 10% of objects:
+Report.header('NS PER OBJECT (WIDE)');
+[500, 1000, 2000].forEach(function(length) {
+  var count = 200;
+  var fields = [['REPLICAS', length, '', 5]];
+  [
+    ['AGREE', {}],
+    ['LAGGING', { lagging: 0.1 }],
+    ['CHAINS', { chains: 0.1 }]
+  ].forEach(function(scenario) {
+    var sources = Scenario.sources(length, objectSize, count, scenario[1]);
+    var wideQuorum = Buffer.alloc(count * Quorum.WIDE_SIZE);
+    var time = fastest(5, count, function() {
+      Quorum.calculateWide(
+        0,
+        objectSize,
+        0,
+        count * objectSize,
+        sources,
+        wideQuorum,
+        0,
+        null,
+        0
+      );
+    });
+    fields.push([scenario[0], time, 'ns', 7]);
+  });
+  Report.row(fields);
+});
+Report.footer();
+
+// Scrubs which verify the CRC32C of every replica's object in the same pass:
+Report.header('NS PER OBJECT (CHECKSUM)');
+[512, 4096].forEach(function(size) {
+  var count = 4096;
+  var checksumOffset = size - Quorum.CHECKSUM;
+  var sources = Scenario.sources(3, size, count, {});
+  sources.forEach(function(source) {
+    Quorum.checksum(checksumOffset, size, 0, count * size, source);
+  });
+  var checksumQuorum = Buffer.alloc(count * Quorum.SIZE);
+  function calculate(options) {
+    return fastest(5, count, function() {
+      Quorum.calculate(
+        0,
+        size,
+        0,
+        count * size,
+        sources,
+        checksumQuorum,
+        0,
+        null,
+        0,
+        options
+      );
+    });
+  }
+  Report.row([
+    ['REPLICAS', 3, '', 2],
+    ['SIZE', size, '', 5],
+    ['CALCULATE', calculate({}), 'ns', 6],
+    ['CHECKSUM', calculate({ checksum: checksumOffset }), 'ns']
+  ]);
+});
+Report.footer();
+
+// Scrubs of replica files (in the page cache, so this measures the cost of
+// the reads, not of the disks), by depth of reads in flight and backend:
+Report.header('NS PER OBJECT (FILES, 3 REPLICAS, SIZE=4096)');
+(function() {
+  var count = 16384;
+  var size = 4096;
+  var sources = Scenario.sources(3, size, count, { lagging: 0.01 });
+  var directory = FS.mkdtempSync(Path.join(OS.tmpdir(), 'quorum-'));
+  var paths = sources.map(function(source, index) {
+    var path = Path.join(directory, String(index));
+    FS.writeFileSync(path, source);
+    return path;
+  });
+  var fds = paths.map(function(path) {
+    return FS.openSync(path, 'r');
+  });
+  var filesQuorum = Buffer.alloc(count * Quorum.SIZE);
+  [1, 2, 8].forEach(function(depth) {
+    var fields = [['DEPTH', depth, '', 2]];
+    [['URING', true], ['PREAD', false]].forEach(function(backend) {
+      var time = fastest(5, count, function() {
+        Quorum.calculateFiles(
+          0,
+          size,
+          0,
+          count * size,
+          fds,
+          filesQuorum,
+          0,
+          null,
+          0,
+          { depth: depth, uring: backend[1] }
+        );
+      });
+      fields.push([backend[0], time, 'ns', 7]);
+    });
+    Report.row(fields);
+  });
+  fds.forEach(FS.closeSync);
+  paths.forEach(FS.unlinkSync);
+  FS.rmdirSync(directory);
+})();
+Report.footer();
+
+// Small calls, where the fixed cost of each call dominates:
+Report.header('NS PER CALL');
+var small = [1, 2, 4, 8, 16];
+var smallSources = [a, a, b];
+function smallCall(length, callback) {
+  var size = length * objectSize;
+  var args = [
+    vectorOffset,
+    objectSize,
+    sourceOffset,
+    size,
+    smallSources,
+    quorum,
+    quorumOffset,
+    target,
+    targetOffset
+  ];
+  if (callback) args.push(callback);
+  Quorum.calculate(...args);
 }
-console.log('');
+(function next(index) {
+  if (index === small.length) {
+    Report.footer();
+    return Report.end();
+  }
+  var length = small[index];
+  var runs = 100000;
+  var time = process.hrtime();
+  for (var run = 0; run < runs; run++) smallCall(length);
+  var elapsed = process.hrtime(time);
+  var sync = Math.round(((elapsed[0] * 1e9) + elapsed[1]) / runs);
+  var asyncRuns = 10000;
+  var asyncTime = process.hrtime();
+  (function loop(run) {
+    if (run === asyncRuns) {
+      var elapsed = process.hrtime(asyncTime);
+      var async = Math.round(((elapsed[0] * 1e9) + elapsed[1]) / asyncRuns);
+      Report.row([
+        ['OBJECTS', length, '', 5],
+        ['SYNC', sync, 'ns', 7],
+        ['ASYNC', async, 'ns']
+      ]);
+      return next(index + 1);
+    }
+    smallCall(length, function(error) {
+      if (error) throw error;
+      loop(run + 1);
+    });
+  })(0);
+})(0);
@@ -3,6 +3,53 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <uv.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+  #define QUORUM_SSE2
+  #include <emmintrin.h>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+  // Compiled with a target attribute and selected at runtime:
+  #define QUORUM_AVX2
+  #define QUORUM_SSE42
+  #include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+  #define QUORUM_NEON
+  #include <arm_neon.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+  #define QUORUM_ARM_CRC32
+  #include <arm_acle.h>
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+  #if __has_include(<linux/io_uring.h>)
+    // io_uring through its system calls, without a dependency on liburing:
+    #include <errno.h>
+    #include <linux/io_uring.h>
+    #include <sys/mman.h>
+    #include <sys/syscall.h>
+    #include <sys/uio.h>
+    #include <unistd.h>
+    #if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+      #define QUORUM_URING
+    #endif
+  #endif
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+  #define QUORUM_PREFETCH(address) __builtin_prefetch((address), 0, 3)
+#elif defined(QUORUM_SSE2)
+  #define QUORUM_PREFETCH(address)                                             \
+    _mm_prefetch((const char*) (address), _MM_HINT_T0)
+#else
+  #define QUORUM_PREFETCH(address) ((void) (address))
+#endif
 
 #define QUORUM_THROW(env, message)                                             \
   do {                                                                         \
@@ -43,64 +90,609 @@
 
 #define QUORUM_SOURCES_MIN 1
 #define QUORUM_SOURCES_MAX 255
+#define QUORUM_THREADS_MAX 64
+#define QUORUM_THREAD_OBJECTS 1024 // Minimum number of objects per thread.
+#define QUORUM_FIXED_MAX 8 // Unanimous check specialized for 1 to 8 replicas.
+#define QUORUM_POOL 64 // Maximum number of idle allocations kept for reuse.
 #define QUORUM_ID 16
-#define QUORUM_NODE 36 // Flags, Index, Length, Dependencies, ID, Dependency.
+#define QUORUM_NODE 24 // Flags, Index, Length, Dependencies, ID, Dependency.
 #define QUORUM_NODES (QUORUM_NODE * 2 * QUORUM_SOURCES_MAX)
+#define QUORUM_SLOTS 1024 // Power of two, at least twice the number of nodes.
+#define QUORUM_SLOTS_MIN 8 // Index nodes only for more than this many vectors.
+#define QUORUM_STACK (2 * QUORUM_SOURCES_MAX) // At most one entry per node.
+#define QUORUM_OWNERS QUORUM_SOURCES_MAX // Node of each vector's leading ID.
 #define QUORUM_VECTOR 32
+#define QUORUM_SCRATCH (                                                       \
+  QUORUM_NODES + QUORUM_SLOTS * 2 + QUORUM_STACK * 4 + QUORUM_OWNERS * 2       \
+)
+#define QUORUM_STREAM 16384 // Bytes of the vector table of options.stream.
+#define QUORUM_STREAM_OBJECTS 256 // Objects in the vector table, at most.
+#define QUORUM_STREAM_AHEAD 16 // Vectors prefetched ahead, across replicas.
+#define QUORUM_BITMAP 32 // One bit for each of at most SOURCES_MAX replicas.
+#define QUORUM_EXTENT 32 // Source, Size, Quorum and Target offsets (uint64 LE).
+#define QUORUM_CACHE 8 // Fingerprint of the vectors of an object (uint64).
+#define QUORUM_SPARSE 8 // Object index (uint32 LE), then its quorum result.
+#define QUORUM_CHECKSUM 4 // CRC32C of the rest of an object (uint32 LE).
+#define QUORUM_CRC32C_POLYNOMIAL 0x82F63B78 // Castagnoli, reflected.
+#define QUORUM_WINDOW 65536 // Default bytes read from each file at a time.
+#define QUORUM_WINDOW_MAX 1073741824 // Maximum bytes of a single read.
+#define QUORUM_DEPTH 2 // Default windows of reads in flight for each file.
+#define QUORUM_DEPTH_MAX 64
+#define QUORUM_IO_THREADS 16 // Threads of the pread fallback, at most.
+#define QUORUM_URING_ENTRIES 4096 // Submission queue entries, at most.
 
 #define QUORUM_DEPENDENT 1 // Node is dependent on another node.
 #define QUORUM_TEMPORARY 2 // Node is part of a cyclic graph.
 #define QUORUM_PERMANENT 4 // Node is already part of a partially ordered set.
+#define QUORUM_MEMBER 8 // Node is part of the longest quorum.
 
 #define QUORUM_ERROR_UNDEFINED -99
 #define QUORUM_ERROR_COMPLETED -98
+#define QUORUM_ERROR_CYCLIC 1
+#define QUORUM_ERROR_ABORTED 2 // options.signal was aborted between chunks.
 
 #define QUORUM_LEADER_OFFSET 0
 #define QUORUM_LENGTH_OFFSET 1
 #define QUORUM_REPAIR_OFFSET 2
 #define QUORUM_FORKED_OFFSET 3
 #define QUORUM_SIZE 4
+#define QUORUM_LEADER_NONE 255 // Leader of an object without a quorum.
+
+// calculateWide() results, with 16-bit fields (little-endian) for up to
+// SOURCES_WIDE_MAX replicas:
+#define QUORUM_SOURCES_WIDE_MAX 65535
+#define QUORUM_WIDE_LEADER_OFFSET 0
+#define QUORUM_WIDE_LENGTH_OFFSET 2
+#define QUORUM_WIDE_REPAIR_OFFSET 4
+#define QUORUM_WIDE_FORKED_OFFSET 6
+#define QUORUM_WIDE_SIZE 8
+
+#define QUORUM_STATS_FAST 0 // Objects calculated on the fast path.
+#define QUORUM_STATS_ORDERED 1 // Slow path, since a chain must be sorted.
+#define QUORUM_STATS_CHAINS 2 // Slow path, since there are over two chains.
+#define QUORUM_STATS_FORKED 3
+#define QUORUM_STATS_CYCLIC 4
+#define QUORUM_STATS_CACHED 5 // Objects skipped by options.cache.
+#define QUORUM_STATS_FAST_NS 6
+#define QUORUM_STATS_SLOW_NS 7
+#define QUORUM_STATS_LENGTH 8 // Histogram of LENGTH, one counter per value.
+#define QUORUM_STATS_REPAIR (QUORUM_STATS_LENGTH + 256) // Histogram of REPAIR.
+#define QUORUM_STATS (QUORUM_STATS_REPAIR + 256)
+
+#define QUORUM_CYCLIC 1 // Vector references itself as a dependency.
+#define QUORUM_EQUAL 2 // Vector has the same ID as the first vector.
+#define QUORUM_ORDERED 4 // Vector is a dependency or dependent of the first.
+#define QUORUM_CLASSES 32 // Number of vectors to classify at a time.
 
 static inline int quorum_equal(const uint8_t* a, const uint8_t* b) {
-  if (a[ 0] != b[ 0]) return 0;
-  if (a[ 1] != b[ 1]) return 0;
-  if (a[ 2] != b[ 2]) return 0;
-  if (a[ 3] != b[ 3]) return 0;
-  if (a[ 4] != b[ 4]) return 0;
-  if (a[ 5] != b[ 5]) return 0;
-  if (a[ 6] != b[ 6]) return 0;
-  if (a[ 7] != b[ 7]) return 0;
-  if (a[ 8] != b[ 8]) return 0;
-  if (a[ 9] != b[ 9]) return 0;
-  if (a[10] != b[10]) return 0;
-  if (a[11] != b[11]) return 0;
-  if (a[12] != b[12]) return 0;
-  if (a[13] != b[13]) return 0;
-  if (a[14] != b[14]) return 0;
-  if (a[15] != b[15]) return 0;
-  return 1;
+#if defined(QUORUM_SSE2)
+  const __m128i x = _mm_loadu_si128((const __m128i*) a);
+  const __m128i y = _mm_loadu_si128((const __m128i*) b);
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) == 0xFFFF;
+#elif defined(QUORUM_NEON)
+  return vminvq_u8(vceqq_u8(vld1q_u8(a), vld1q_u8(b))) == 0xFF;
+#else
+  uint64_t x[2];
+  uint64_t y[2];
+  memcpy(x, a, QUORUM_ID);
+  memcpy(y, b, QUORUM_ID);
+  return ((x[0] ^ y[0]) | (x[1] ^ y[1])) == 0;
+#endif
+}
+
+// Classify each vector against the first vector, so that the fast path need
+// only compare against the second chain, if any, as it scans the classes:
+typedef void (*quorum_classify_kernel)(
+  uint8_t** vectors,
+  const int64_t vectorsLength,
+  const int64_t vectorOffset,
+  const uint8_t* a,
+  uint8_t* classes
+);
+
+static void quorum_classify_scalar(
+  uint8_t** vectors,
+  const int64_t vectorsLength,
+  const int64_t vectorOffset,
+  const uint8_t* a,
+  uint8_t* classes
+) {
+  for (int64_t index = 0; index < vectorsLength; index++) {
+    const uint8_t* vector = vectors[index] + vectorOffset;
+    uint8_t class = 0;
+    if (quorum_equal(vector, vector + QUORUM_ID)) class |= QUORUM_CYCLIC;
+    if (quorum_equal(vector, a)) class |= QUORUM_EQUAL;
+    if (
+      quorum_equal(vector, a + QUORUM_ID) ||
+      quorum_equal(a, vector + QUORUM_ID)
+    ) {
+      class |= QUORUM_ORDERED;
+    }
+    classes[index] = class;
+  }
+}
+
+static inline uint8_t quorum_classify_same(const uint8_t* a) {
+  // The class of any vector identical to the first, most vectors in practice:
+  if (quorum_equal(a, a + QUORUM_ID)) {
+    return QUORUM_CYCLIC | QUORUM_EQUAL | QUORUM_ORDERED;
+  }
+  return QUORUM_EQUAL;
+}
+
+#if defined(QUORUM_SSE2)
+static void quorum_classify_sse2(
+  uint8_t** vectors,
+  const int64_t vectorsLength,
+  const int64_t vectorOffset,
+  const uint8_t* a,
+  uint8_t* classes
+) {
+  const __m128i a0 = _mm_loadu_si128((const __m128i*) a);
+  const __m128i a1 = _mm_loadu_si128((const __m128i*) (a + QUORUM_ID));
+  const uint8_t same = quorum_classify_same(a);
+  for (int64_t index = 0; index < vectorsLength; index++) {
+    const uint8_t* vector = vectors[index] + vectorOffset;
+    const __m128i v0 = _mm_loadu_si128((const __m128i*) vector);
+    const __m128i v1 = _mm_loadu_si128((const __m128i*) (vector + QUORUM_ID));
+    const __m128i e0 = _mm_cmpeq_epi8(v0, a0);
+    const __m128i e1 = _mm_cmpeq_epi8(v1, a1);
+    if (_mm_movemask_epi8(_mm_and_si128(e0, e1)) == 0xFFFF) {
+      classes[index] = same;
+      continue;
+    }
+    const int cyclic = _mm_movemask_epi8(_mm_cmpeq_epi8(v0, v1)) == 0xFFFF;
+    const int equal = _mm_movemask_epi8(e0) == 0xFFFF;
+    const int ordered = (
+      _mm_movemask_epi8(_mm_cmpeq_epi8(v0, a1)) == 0xFFFF ||
+      _mm_movemask_epi8(_mm_cmpeq_epi8(v1, a0)) == 0xFFFF
+    );
+    classes[index] = (uint8_t) (
+      (cyclic * QUORUM_CYCLIC) |
+      (equal * QUORUM_EQUAL) |
+      (ordered * QUORUM_ORDERED)
+    );
+  }
+}
+#endif
+
+#if defined(QUORUM_AVX2)
+__attribute__((target("avx2")))
+static void quorum_classify_avx2(
+  uint8_t** vectors,
+  const int64_t vectorsLength,
+  const int64_t vectorOffset,
+  const uint8_t* a,
+  uint8_t* classes
+) {
+  // Compare both IDs of a vector in a single 256-bit lane:
+  const __m256i x = _mm256_loadu_si256((const __m256i*) a);
+  const __m256i y = _mm256_permute4x64_epi64(x, 0x4E); // Swap the two IDs.
+  const uint8_t same = quorum_classify_same(a);
+  for (int64_t index = 0; index < vectorsLength; index++) {
+    const uint8_t* vector = vectors[index] + vectorOffset;
+    const __m256i v = _mm256_loadu_si256((const __m256i*) vector);
+    const uint32_t equal = (uint32_t) _mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(v, x)
+    );
+    if (equal == 0xFFFFFFFF) {
+      classes[index] = same;
+      continue;
+    }
+    const __m256i w = _mm256_permute4x64_epi64(v, 0x4E);
+    const uint32_t cyclic = (uint32_t) _mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(v, w)
+    );
+    // The low half compares vector[0] with a[1], the high half compares
+    // vector[1] with a[0]:
+    const uint32_t ordered = (uint32_t) _mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(v, y)
+    );
+    classes[index] = (uint8_t) (
+      (((cyclic & 0xFFFF) == 0xFFFF) * QUORUM_CYCLIC) |
+      (((equal & 0xFFFF) == 0xFFFF) * QUORUM_EQUAL) |
+      (
+        ((ordered & 0xFFFF) == 0xFFFF || (ordered >> 16) == 0xFFFF) *
+        QUORUM_ORDERED
+      )
+    );
+  }
+}
+#endif
+
+#if defined(QUORUM_SSE2)
+static quorum_classify_kernel quorum_classify = quorum_classify_sse2;
+#else
+static quorum_classify_kernel quorum_classify = quorum_classify_scalar;
+#endif
+
+// CRC32C kernels continue a raw (not inverted) CRC over length bytes:
+typedef uint32_t (*quorum_crc32c_kernel)(
+  uint32_t crc,
+  const uint8_t* data,
+  int64_t length
+);
+
+static uv_once_t quorum_crc32c_once = UV_ONCE_INIT;
+static uint32_t quorum_crc32c_table[8][256];
+
+static void quorum_crc32c_init(void) {
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    uint32_t crc = byte;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ (QUORUM_CRC32C_POLYNOMIAL & (0 - (crc & 1)));
+    }
+    quorum_crc32c_table[0][byte] = crc;
+  }
+  for (uint32_t byte = 0; byte < 256; byte++) {
+    for (int slice = 1; slice < 8; slice++) {
+      const uint32_t crc = quorum_crc32c_table[slice - 1][byte];
+      quorum_crc32c_table[slice][byte] = (
+        (crc >> 8) ^ quorum_crc32c_table[0][crc & 0xFF]
+      );
+    }
+  }
+}
+
+static uint32_t quorum_crc32c_scalar(
+  uint32_t crc,
+  const uint8_t* data,
+  int64_t length
+) {
+  // Slicing-by-8, eight table lookups for each 64-bit word:
+  const uint32_t (*table)[256] = quorum_crc32c_table;
+  while (length >= 8) {
+    const uint32_t low = crc ^ (
+      ((uint32_t) data[0]) |
+      ((uint32_t) data[1] << 8) |
+      ((uint32_t) data[2] << 16) |
+      ((uint32_t) data[3] << 24)
+    );
+    crc = (
+      table[7][low & 0xFF] ^
+      table[6][(low >> 8) & 0xFF] ^
+      table[5][(low >> 16) & 0xFF] ^
+      table[4][low >> 24] ^
+      table[3][data[4]] ^
+      table[2][data[5]] ^
+      table[1][data[6]] ^
+      table[0][data[7]]
+    );
+    data += 8;
+    length -= 8;
+  }
+  while (length-- > 0) crc = (crc >> 8) ^ table[0][(crc ^ *data++) & 0xFF];
+  return crc;
+}
+
+#if defined(QUORUM_SSE42)
+__attribute__((target("sse4.2")))
+static uint32_t quorum_crc32c_sse42(
+  uint32_t crc,
+  const uint8_t* data,
+  int64_t length
+) {
+  uint64_t crc64 = crc;
+  while (length >= 8) {
+    uint64_t word;
+    memcpy(&word, data, 8);
+    crc64 = _mm_crc32_u64(crc64, word);
+    data += 8;
+    length -= 8;
+  }
+  crc = (uint32_t) crc64;
+  while (length-- > 0) crc = _mm_crc32_u8(crc, *data++);
+  return crc;
+}
+#endif
+
+#if defined(QUORUM_ARM_CRC32)
+static uint32_t quorum_crc32c_arm(
+  uint32_t crc,
+  const uint8_t* data,
+  int64_t length
+) {
+  while (length >= 8) {
+    uint64_t word;
+    memcpy(&word, data, 8);
+    crc = __crc32cd(crc, word);
+    data += 8;
+    length -= 8;
+  }
+  while (length-- > 0) crc = __crc32cb(crc, *data++);
+  return crc;
+}
+#endif
+
+// A single CRC is a chain of dependent instructions, bound by their latency
+// rather than their throughput, so replicas are verified three at a time,
+// each continuing its own CRC over the same length:
+typedef void (*quorum_crc32c_x3_kernel)(
+  uint32_t* crc,
+  const uint8_t** data,
+  int64_t length
+);
+
+static void quorum_crc32c_x3_scalar(
+  uint32_t* crc,
+  const uint8_t** data,
+  int64_t length
+) {
+  for (int index = 0; index < 3; index++) {
+    crc[index] = quorum_crc32c_scalar(crc[index], data[index], length);
+  }
+}
+
+#if defined(QUORUM_SSE42)
+__attribute__((target("sse4.2")))
+static void quorum_crc32c_x3_sse42(
+  uint32_t* crc,
+  const uint8_t** data,
+  int64_t length
+) {
+  uint64_t a = crc[0];
+  uint64_t b = crc[1];
+  uint64_t c = crc[2];
+  int64_t offset = 0;
+  for (; offset + 8 <= length; offset += 8) {
+    uint64_t words[3];
+    memcpy(words + 0, data[0] + offset, 8);
+    memcpy(words + 1, data[1] + offset, 8);
+    memcpy(words + 2, data[2] + offset, 8);
+    a = _mm_crc32_u64(a, words[0]);
+    b = _mm_crc32_u64(b, words[1]);
+    c = _mm_crc32_u64(c, words[2]);
+  }
+  crc[0] = (uint32_t) a;
+  crc[1] = (uint32_t) b;
+  crc[2] = (uint32_t) c;
+  for (; offset < length; offset++) {
+    crc[0] = _mm_crc32_u8(crc[0], data[0][offset]);
+    crc[1] = _mm_crc32_u8(crc[1], data[1][offset]);
+    crc[2] = _mm_crc32_u8(crc[2], data[2][offset]);
+  }
+}
+#endif
+
+#if defined(QUORUM_ARM_CRC32)
+static void quorum_crc32c_x3_arm(
+  uint32_t* crc,
+  const uint8_t** data,
+  int64_t length
+) {
+  uint32_t a = crc[0];
+  uint32_t b = crc[1];
+  uint32_t c = crc[2];
+  int64_t offset = 0;
+  for (; offset + 8 <= length; offset += 8) {
+    uint64_t words[3];
+    memcpy(words + 0, data[0] + offset, 8);
+    memcpy(words + 1, data[1] + offset, 8);
+    memcpy(words + 2, data[2] + offset, 8);
+    a = __crc32cd(a, words[0]);
+    b = __crc32cd(b, words[1]);
+    c = __crc32cd(c, words[2]);
+  }
+  for (; offset < length; offset++) {
+    a = __crc32cb(a, data[0][offset]);
+    b = __crc32cb(b, data[1][offset]);
+    c = __crc32cb(c, data[2][offset]);
+  }
+  crc[0] = a;
+  crc[1] = b;
+  crc[2] = c;
+}
+#endif
+
+#if defined(QUORUM_ARM_CRC32)
+static quorum_crc32c_kernel quorum_crc32c = quorum_crc32c_arm;
+static quorum_crc32c_x3_kernel quorum_crc32c_x3 = quorum_crc32c_x3_arm;
+#else
+static quorum_crc32c_kernel quorum_crc32c = quorum_crc32c_scalar;
+static quorum_crc32c_x3_kernel quorum_crc32c_x3 = quorum_crc32c_x3_scalar;
+#endif
+
+// Set only by tests, to use quorum_fast() for any number of vectors:
+static int quorum_fast_generic = 0;
+
+// Set by the first method which may use the kernels, after which they are
+// read by other threads and may no longer be changed by tests:
+static int quorum_kernels_used = 0;
+static uv_mutex_t quorum_kernels_mutex;
+
+static uv_once_t quorum_kernels_once = UV_ONCE_INIT;
+
+// Selects the widest kernels which the CPU supports:
+static void quorum_kernels_native(void) {
+#if defined(QUORUM_SSE2)
+  quorum_classify = quorum_classify_sse2;
+#else
+  quorum_classify = quorum_classify_scalar;
+#endif
+#if defined(QUORUM_ARM_CRC32)
+  quorum_crc32c = quorum_crc32c_arm;
+  quorum_crc32c_x3 = quorum_crc32c_x3_arm;
+#else
+  quorum_crc32c = quorum_crc32c_scalar;
+  quorum_crc32c_x3 = quorum_crc32c_x3_scalar;
+#endif
+#if defined(QUORUM_AVX2)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) quorum_classify = quorum_classify_avx2;
+#endif
+#if defined(QUORUM_SSE42)
+  if (__builtin_cpu_supports("sse4.2")) {
+    quorum_crc32c = quorum_crc32c_sse42;
+    quorum_crc32c_x3 = quorum_crc32c_x3_sse42;
+  }
+#endif
+  quorum_fast_generic = 0;
+}
+
+static void quorum_kernels_scalar(void) {
+  quorum_classify = quorum_classify_scalar;
+  quorum_crc32c = quorum_crc32c_scalar;
+  quorum_crc32c_x3 = quorum_crc32c_x3_scalar;
+  quorum_fast_generic = 0;
+}
+
+static void quorum_kernels(void) {
+  assert(uv_mutex_init(&quorum_kernels_mutex) == 0);
+  quorum_kernels_native();
+}
+
+static void quorum_kernels_use(void) {
+  uv_mutex_lock(&quorum_kernels_mutex);
+  quorum_kernels_used = 1;
+  uv_mutex_unlock(&quorum_kernels_mutex);
+}
+
+static inline uint32_t quorum_checksum(
+  const uint8_t* object,
+  const int64_t objectSize,
+  const int64_t checksumOffset
+) {
+  assert(checksumOffset >= 0);
+  assert(checksumOffset + QUORUM_CHECKSUM <= objectSize);
+  // Every byte of the object is covered, except for the checksum itself:
+  uint32_t crc = quorum_crc32c(0xFFFFFFFF, object, checksumOffset);
+  crc = quorum_crc32c(
+    crc,
+    object + checksumOffset + QUORUM_CHECKSUM,
+    objectSize - checksumOffset - QUORUM_CHECKSUM
+  );
+  return ~crc;
+}
+
+static inline int quorum_checksum_equal(
+  const uint8_t* object,
+  const int64_t checksumOffset,
+  const uint32_t crc
+) {
+  const uint8_t* checksum = object + checksumOffset;
+  return crc == (
+    ((uint32_t) checksum[0]) |
+    ((uint32_t) checksum[1] << 8) |
+    ((uint32_t) checksum[2] << 16) |
+    ((uint32_t) checksum[3] << 24)
+  );
+}
+
+// Sets a bit in corrupt for each replica whose object fails its checksum:
+static void quorum_verify(
+  uint8_t** sources,
+  const int64_t sourcesLength,
+  const int64_t sourceOffset,
+  const int64_t objectSize,
+  const int64_t checksumOffset,
+  uint8_t* corrupt
+) {
+  assert(sourcesLength <= QUORUM_BITMAP * 8);
+  memset(corrupt, 0, QUORUM_BITMAP);
+  const int64_t tail = checksumOffset + QUORUM_CHECKSUM;
+  int64_t index = 0;
+  for (; index + 3 <= sourcesLength; index += 3) {
+    uint32_t crc[3] = { 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF };
+    const uint8_t* data[3];
+    for (int k = 0; k < 3; k++) data[k] = sources[index + k] + sourceOffset;
+    quorum_crc32c_x3(crc, data, checksumOffset);
+    for (int k = 0; k < 3; k++) data[k] += tail;
+    quorum_crc32c_x3(crc, data, objectSize - tail);
+    for (int k = 0; k < 3; k++) {
+      const int64_t replica = index + k;
+      if (
+        !quorum_checksum_equal(
+          sources[replica] + sourceOffset,
+          checksumOffset,
+          ~crc[k]
+        )
+      ) {
+        corrupt[replica >> 3] |= 1 << (replica & 7);
+      }
+    }
+  }
+  for (; index < sourcesLength; index++) {
+    const uint8_t* object = sources[index] + sourceOffset;
+    if (
+      !quorum_checksum_equal(
+        object,
+        checksumOffset,
+        quorum_checksum(object, objectSize, checksumOffset)
+      )
+    ) {
+      corrupt[index >> 3] |= 1 << (index & 7);
+    }
+  }
+}
+
+static inline uint32_t quorum_hash(const uint8_t* id) {
+  // IDs are random, so the leading bytes of an ID are already a good hash:
+  return (
+    ((uint32_t) id[0]) |
+    ((uint32_t) id[1] << 8) |
+    ((uint32_t) id[2] << 16) |
+    ((uint32_t) id[3] << 24)
+  );
 }
 
-static int64_t quorum_node(
+static inline int64_t quorum_slots(const int64_t vectorsLength) {
+  // A linear scan of a few nodes is faster than clearing and probing slots:
+  if (vectorsLength <= QUORUM_SLOTS_MIN) return 0;
+  // Each vector inserts at most two nodes, keep the load factor at most 0.5:
+  int64_t slots = 4;
+  while (slots < vectorsLength * 4) slots *= 2;
+  assert(slots <= QUORUM_SLOTS);
+  return slots;
+}
+
+static inline int64_t quorum_node(
   const uint8_t* nodes,
   const int64_t nodesLength,
+  uint16_t* slots,
+  const int64_t slotsMask,
   const uint8_t* vector
 ) {
-  int64_t nodesOffset = 0;
-  while (nodesOffset < nodesLength) {
+  if (slots == NULL) {
+    int64_t nodesOffset = 0;
+    while (nodesOffset < nodesLength) {
+      if (quorum_equal(nodes + nodesOffset + 4, vector)) return nodesOffset;
+      nodesOffset += QUORUM_NODE;
+    }
+    assert(nodesLength < QUORUM_NODES);
+    return -(nodesLength + 1);
+  }
+  // Open addressing with linear probing, a slot stores the node number + 1:
+  int64_t slot = quorum_hash(vector) & slotsMask;
+  while (slots[slot] != 0) {
+    int64_t nodesOffset = (int64_t) (slots[slot] - 1) * QUORUM_NODE;
+    assert(nodesOffset < nodesLength);
     if (quorum_equal(nodes + nodesOffset + 4, vector)) return nodesOffset;
-    nodesOffset += QUORUM_NODE;
+    slot = (slot + 1) & slotsMask;
   }
   // Assert free space remains for an insert:
   assert(nodesLength < QUORUM_NODES);
+  // Reserve the slot, the caller must insert the node at nodesLength:
+  slots[slot] = (uint16_t) (nodesLength / QUORUM_NODE + 1);
   return -(nodesLength + 1);
 };
 
+static inline uint32_t quorum_dependency(
+  const uint8_t* nodes,
+  const int64_t nodesOffset
+) {
+  uint32_t dependency;
+  memcpy(&dependency, nodes + nodesOffset + 4 + QUORUM_ID, sizeof(uint32_t));
+  return dependency;
+}
+
 static int64_t quorum_nodes(
   uint8_t** vectors,
   const int64_t vectorsLength,
   const int64_t vectorOffset,
-  uint8_t* nodes
+  uint8_t* nodes,
+  uint16_t* slots,
+  const int64_t slotsMask,
+  uint16_t* owners
 ) {
   assert(vectorsLength >= QUORUM_SOURCES_MIN);
   assert(vectorsLength <= QUORUM_SOURCES_MAX);
@@ -108,77 +700,107 @@ static int64_t quorum_nodes(
   int64_t nodesLength = 0;
   for (int64_t index = 0; index < vectorsLength; index++) {
     const uint8_t* vector = vectors[index] + vectorOffset;
-    int64_t nodesOffset = quorum_node(nodes, nodesLength, vector);
+    int64_t nodesOffset = quorum_node(
+      nodes,
+      nodesLength,
+      slots,
+      slotsMask,
+      vector
+    );
+    // Whether this vector is the first to describe the node's dependency:
+    int dependent = 0;
     if (nodesOffset < 0) {
       nodesOffset = -(nodesOffset + 1);
       nodes[nodesOffset + 0] = QUORUM_DEPENDENT;
       nodes[nodesOffset + 1] = (uint8_t) index;
       nodes[nodesOffset + 2] = 1;
       nodes[nodesOffset + 3] = 0;
-      memcpy(nodes + nodesOffset + 4, vector, QUORUM_VECTOR);
+      memcpy(nodes + nodesOffset + 4, vector, QUORUM_ID);
       nodesLength += QUORUM_NODE;
+      dependent = 1;
     } else {
       nodes[nodesOffset + 2]++;
       if ((nodes[nodesOffset] & QUORUM_DEPENDENT) == 0) {
         nodes[nodesOffset] |= QUORUM_DEPENDENT;
-        memcpy(
-          nodes + nodesOffset + 4 + QUORUM_ID,
-          vector + QUORUM_ID,
-          QUORUM_ID
-        );
+        dependent = 1;
       }
     }
-    nodesOffset = quorum_node(nodes, nodesLength, vector + QUORUM_ID);
-    if (nodesOffset < 0) {
-      nodesOffset = -(nodesOffset + 1);
-      nodes[nodesOffset + 0] = 0;
-      nodes[nodesOffset + 1] = 0;
-      nodes[nodesOffset + 2] = 0;
-      nodes[nodesOffset + 3] = 0;
-      memcpy(nodes + nodesOffset + 4, vector + QUORUM_ID, QUORUM_ID);
+    assert(nodesOffset <= UINT16_MAX);
+    owners[index] = (uint16_t) nodesOffset;
+    int64_t dependencyOffset = quorum_node(
+      nodes,
+      nodesLength,
+      slots,
+      slotsMask,
+      vector + QUORUM_ID
+    );
+    if (dependencyOffset < 0) {
+      dependencyOffset = -(dependencyOffset + 1);
+      nodes[dependencyOffset + 0] = 0;
+      nodes[dependencyOffset + 1] = 0;
+      nodes[dependencyOffset + 2] = 0;
+      nodes[dependencyOffset + 3] = 0;
+      memcpy(nodes + dependencyOffset + 4, vector + QUORUM_ID, QUORUM_ID);
       nodesLength += QUORUM_NODE;
     }
+    if (dependent) {
+      // Resolve the dependency once, so that the sort never searches for it:
+      uint32_t dependency = (uint32_t) dependencyOffset;
+      memcpy(
+        nodes + nodesOffset + 4 + QUORUM_ID,
+        &dependency,
+        sizeof(uint32_t)
+      );
+    }
   }
   return nodesLength;
 };
 
 static int quorum_visit(
   uint8_t* nodes,
-  const int64_t nodesOffset,
+  int64_t nodesOffset,
   const int64_t nodesLength,
-  uint8_t* quorum,
-  uint8_t* count
+  uint32_t* stack,
+  uint8_t* quorum
 ) {
-  assert(nodesOffset >= 0); // A dependency was not found.
-  assert(nodesLength > 0);
-  if (nodes[nodesOffset] & QUORUM_PERMANENT) {
-    *count = nodes[nodesOffset + 2];
-    return 0;
+  assert(nodesOffset >= 0);
+  assert(nodesOffset < nodesLength);
+  // Follow the chain of dependencies down to a node that is either already
+  // sorted or has no dependency, pushing each unsorted node onto the stack:
+  int64_t stackLength = 0;
+  uint8_t count = 0;
+  while (1) {
+    if (nodes[nodesOffset] & QUORUM_PERMANENT) {
+      count = nodes[nodesOffset + 2];
+      break;
+    }
+    if (nodes[nodesOffset] & QUORUM_TEMPORARY) return 1;
+    nodes[nodesOffset] |= QUORUM_TEMPORARY;
+    assert(stackLength < QUORUM_STACK);
+    stack[stackLength++] = (uint32_t) nodesOffset;
+    if ((nodes[nodesOffset] & QUORUM_DEPENDENT) == 0) break;
+    nodesOffset = (int64_t) quorum_dependency(nodes, nodesOffset);
+    assert(nodesOffset < nodesLength);
   }
-  if (nodes[nodesOffset] & QUORUM_TEMPORARY) return 1;
-  nodes[nodesOffset] |= QUORUM_TEMPORARY;
-  if (nodes[nodesOffset] & QUORUM_DEPENDENT) {
-    int error = quorum_visit(
-      nodes,
-      quorum_node(nodes, nodesLength, nodes + nodesOffset + 4 + QUORUM_ID),
-      nodesLength,
-      quorum,
-      nodes + nodesOffset + 3
-    );
-    if (error) return error;
-    assert(nodes[nodesOffset + 2] + nodes[nodesOffset + 3] <= UINT8_MAX);
-    nodes[nodesOffset + 2] += nodes[nodesOffset + 3];
-  }
-  nodes[nodesOffset] |= QUORUM_PERMANENT;
-  if (quorum[QUORUM_LENGTH_OFFSET] < nodes[nodesOffset + 2]) {
-    quorum[QUORUM_LEADER_OFFSET] = nodes[nodesOffset + 1];
-    quorum[QUORUM_LENGTH_OFFSET] = nodes[nodesOffset + 2];
-    quorum[QUORUM_REPAIR_OFFSET] = nodes[nodesOffset + 3];
-    quorum[QUORUM_FORKED_OFFSET] = 0;
-  } else if (quorum[QUORUM_LENGTH_OFFSET] == nodes[nodesOffset + 2]) {
-    quorum[QUORUM_FORKED_OFFSET] = 1;
+  // Unwind the stack, adding the length of each dependency to its dependent:
+  while (stackLength > 0) {
+    nodesOffset = (int64_t) stack[--stackLength];
+    if (nodes[nodesOffset] & QUORUM_DEPENDENT) {
+      nodes[nodesOffset + 3] = count;
+      assert(nodes[nodesOffset + 2] + nodes[nodesOffset + 3] <= UINT8_MAX);
+      nodes[nodesOffset + 2] += nodes[nodesOffset + 3];
+    }
+    nodes[nodesOffset] |= QUORUM_PERMANENT;
+    if (quorum[QUORUM_LENGTH_OFFSET] < nodes[nodesOffset + 2]) {
+      quorum[QUORUM_LEADER_OFFSET] = nodes[nodesOffset + 1];
+      quorum[QUORUM_LENGTH_OFFSET] = nodes[nodesOffset + 2];
+      quorum[QUORUM_REPAIR_OFFSET] = nodes[nodesOffset + 3];
+      quorum[QUORUM_FORKED_OFFSET] = 0;
+    } else if (quorum[QUORUM_LENGTH_OFFSET] == nodes[nodesOffset + 2]) {
+      quorum[QUORUM_FORKED_OFFSET] = 1;
+    }
+    count = nodes[nodesOffset + 2];
   }
-  *count = nodes[nodesOffset + 2];
   return 0;
 };
 
@@ -196,17 +818,34 @@ static int quorum_slow(
   quorum[QUORUM_LENGTH_OFFSET] = 0; // Length
   quorum[QUORUM_REPAIR_OFFSET] = 0; // Repair
   quorum[QUORUM_FORKED_OFFSET] = 0; // Forked
+  // The hash index and stack follow the node records in the scratch buffer:
+  const int64_t slotsLength = quorum_slots(vectorsLength);
+  uint16_t* slots = NULL;
+  if (slotsLength > 0) {
+    slots = (uint16_t*) (nodes + QUORUM_NODES);
+    memset(slots, 0, slotsLength * sizeof(uint16_t));
+  }
+  uint32_t* stack = (uint32_t*) (nodes + QUORUM_NODES + QUORUM_SLOTS * 2);
+  uint16_t* owners = (uint16_t*) (stack + QUORUM_STACK);
   int64_t nodesOffset = 0;
   int64_t nodesLength = quorum_nodes(
     vectors,
     vectorsLength,
     vectorOffset,
-    nodes
+    nodes,
+    slots,
+    slotsLength - 1,
+    owners
   );
   while (nodesOffset < nodesLength) {
     if ((nodes[nodesOffset] & (QUORUM_TEMPORARY | QUORUM_PERMANENT)) == 0) {
-      uint8_t count = 0;
-      int error = quorum_visit(nodes, nodesOffset, nodesLength, quorum, &count);
+      int error = quorum_visit(
+        nodes,
+        nodesOffset,
+        nodesLength,
+        stack,
+        quorum
+      );
       if (error) return error;
     }
     nodesOffset += QUORUM_NODE;
@@ -226,45 +865,54 @@ static int quorum_fast(
   const int64_t vectorsLength,
   const int64_t vectorOffset,
   uint8_t* nodes,
-  uint8_t* quorum
+  uint8_t* quorum,
+  int* path
 ) {
   assert(vectorsLength >= QUORUM_SOURCES_MIN);
   assert(vectorsLength <= QUORUM_SOURCES_MAX);
   assert(vectorOffset >= 0);
-  const uint8_t* a = NULL;
+  *path = QUORUM_STATS_FAST;
+  const uint8_t* a = vectors[0] + vectorOffset;
   const uint8_t* b = NULL;
   int64_t aIndex = 0;
   int64_t bIndex = 0;
   int64_t aLength = 0;
   int64_t bLength = 0;
+  uint8_t classes[QUORUM_CLASSES];
   for (int64_t index = 0; index < vectorsLength; index++) {
-    const uint8_t* vector = vectors[index] + vectorOffset;
+    // Classify vectors a block at a time, to exit early for the slow path:
+    if (index % QUORUM_CLASSES == 0) {
+      quorum_classify(
+        vectors + index,
+        vectorsLength - index < QUORUM_CLASSES ?
+          vectorsLength - index : QUORUM_CLASSES,
+        vectorOffset,
+        a,
+        classes
+      );
+    }
+    const uint8_t class = classes[index % QUORUM_CLASSES];
     // Vector references itself as a dependency (cyclic reference):
-    if (quorum_equal(vector, vector + QUORUM_ID)) return 1;
-    if (aLength == 0) {
-      a = vector;
-      aIndex = index;
-      aLength++;
-    } else if (quorum_equal(vector, a)) {
+    if (class & QUORUM_CYCLIC) return 1;
+    if (class & QUORUM_EQUAL) {
       // The two vectors must be identical if the leading IDs are identical.
       // We assume that random IDs collide only for the same dependency.
       aLength++;
-    } else if (
-      quorum_equal(vector, a + QUORUM_ID) ||
-      quorum_equal(a, vector + QUORUM_ID)
-    ) {
+    } else if (class & QUORUM_ORDERED) {
       // The two vectors are part of the same chain, but an order exists.
       // We must exit the fast path and perform a topological sort.
+      *path = QUORUM_STATS_ORDERED;
       return quorum_slow(vectors, vectorsLength, vectorOffset, nodes, quorum);
     } else if (bLength == 0) {
-      b = vector;
+      b = vectors[index] + vectorOffset;
       bIndex = index;
       bLength++;
-    } else if (quorum_equal(vector, b)) {
+    } else if (quorum_equal(vectors[index] + vectorOffset, b)) {
       bLength++;
     } else {
       // We have more than two chains, or require the second to be sorted.
       // We must exit the fast path and perform a topological sort.
+      *path = QUORUM_STATS_CHAINS;
       return quorum_slow(vectors, vectorsLength, vectorOffset, nodes, quorum);
     }
   }
@@ -294,153 +942,3686 @@ static int quorum_fast(
   return 0;
 }
 
-static int quorum_iterate(
+// Most deployments have a few replicas which almost always agree. For these,
+// a kernel specialized for the number of replicas compares every vector with
+// the first in full, without branches, and only falls back to quorum_fast()
+// if any vector differs. Only this unanimous check is specialized: selecting
+// the majority from bitmasks of the vectors measured no faster than
+// quorum_fast() for 8 or fewer replicas, and slowed the unanimous check. The
+// kernel is chosen once per call, not per object:
+typedef int (*quorum_fast_kernel)(
+  uint8_t** vectors,
+  const int64_t vectorsLength,
   const int64_t vectorOffset,
-  const int64_t objectSize,
-  const int64_t sourceSize,
-  uint8_t** sources,
-  const int64_t sourcesLength,
+  uint8_t* nodes,
+  uint8_t* quorum,
+  int* path
+);
+
+static inline int quorum_fast_fixed(
+  uint8_t** vectors,
+  const int64_t vectorsLength,
+  const int64_t vectorOffset,
+  uint8_t* nodes,
   uint8_t* quorum,
-  uint8_t* target
+  int* path
+) {
+  uint64_t a[4];
+  memcpy(a, vectors[0] + vectorOffset, QUORUM_VECTOR);
+  uint64_t difference = 0;
+  for (int64_t index = 1; index < vectorsLength; index++) {
+    uint64_t b[4];
+    memcpy(b, vectors[index] + vectorOffset, QUORUM_VECTOR);
+    difference |= (a[0] ^ b[0]) | (a[1] ^ b[1]) | (a[2] ^ b[2]) | (a[3] ^ b[3]);
+  }
+  // Every vector is identical and the first does not reference itself:
+  if (difference == 0 && ((a[0] ^ a[2]) | (a[1] ^ a[3])) != 0) {
+    *path = QUORUM_STATS_FAST;
+    quorum[QUORUM_LEADER_OFFSET] = 0;
+    quorum[QUORUM_LENGTH_OFFSET] = (uint8_t) vectorsLength;
+    quorum[QUORUM_REPAIR_OFFSET] = 0;
+    quorum[QUORUM_FORKED_OFFSET] = 0;
+    return 0;
+  }
+  return quorum_fast(vectors, vectorsLength, vectorOffset, nodes, quorum, path);
+}
+
+#define QUORUM_FAST_FIXED(length)                                              \
+  static int quorum_fast_##length(                                             \
+    uint8_t** vectors,                                                         \
+    const int64_t vectorsLength,                                               \
+    const int64_t vectorOffset,                                                \
+    uint8_t* nodes,                                                            \
+    uint8_t* quorum,                                                           \
+    int* path                                                                  \
+  ) {                                                                          \
+    assert(vectorsLength == (length));                                         \
+    return quorum_fast_fixed(                                                  \
+      vectors,                                                                 \
+      (length),                                                                \
+      vectorOffset,                                                            \
+      nodes,                                                                   \
+      quorum,                                                                  \
+      path                                                                     \
+    );                                                                         \
+  }
+
+QUORUM_FAST_FIXED(1)
+QUORUM_FAST_FIXED(2)
+QUORUM_FAST_FIXED(3)
+QUORUM_FAST_FIXED(4)
+QUORUM_FAST_FIXED(5)
+QUORUM_FAST_FIXED(6)
+QUORUM_FAST_FIXED(7)
+QUORUM_FAST_FIXED(8)
+
+static const quorum_fast_kernel quorum_fast_fixed_kernels[] = {
+  NULL,
+  quorum_fast_1,
+  quorum_fast_2,
+  quorum_fast_3,
+  quorum_fast_4,
+  quorum_fast_5,
+  quorum_fast_6,
+  quorum_fast_7,
+  quorum_fast_8
+};
+
+static quorum_fast_kernel quorum_fast_select(const int64_t vectorsLength) {
+  assert(vectorsLength >= QUORUM_SOURCES_MIN);
+  if (vectorsLength <= QUORUM_FIXED_MAX && !quorum_fast_generic) {
+    return quorum_fast_fixed_kernels[vectorsLength];
+  }
+  return quorum_fast;
+}
+
+static void quorum_members(
+  uint8_t** vectors,
+  const int64_t vectorsLength,
+  const int64_t vectorOffset,
+  uint8_t* nodes,
+  const uint8_t* quorum,
+  uint8_t* members,
+  uint8_t* lagging
 ) {
+  assert(vectorsLength >= QUORUM_SOURCES_MIN);
+  assert(vectorsLength <= QUORUM_SOURCES_MAX);
+  assert(vectorsLength <= QUORUM_BITMAP * 8);
   assert(vectorOffset >= 0);
-  assert(objectSize >= 0);
-  assert(objectSize >= vectorOffset + QUORUM_VECTOR);
-  assert(sourceSize >= 0);
-  assert(sourceSize >= objectSize);
-  assert(sourceSize % objectSize == 0);
-  assert(sourcesLength >= QUORUM_SOURCES_MIN);
-  assert(sourcesLength <= QUORUM_SOURCES_MAX);
-  assert(sourcesLength <= UINT8_MAX);
-  assert(sourcesLength <= 255);
-  int64_t sourceOffset = 0;
-  uint8_t* nodes = malloc(QUORUM_NODES);
-  assert(nodes != NULL);
-  int error = 0;
-  while (sourceOffset < sourceSize) {
-    assert(sourceOffset + objectSize <= sourceSize);
-    assert(sourceOffset + vectorOffset + QUORUM_VECTOR <= sourceSize);
-    error = quorum_fast(
-      sources,
-      sourcesLength,
-      sourceOffset + vectorOffset,
-      nodes,
-      quorum
+  if (members != NULL) memset(members, 0, QUORUM_BITMAP);
+  if (lagging != NULL) memset(lagging, 0, QUORUM_BITMAP);
+  if (quorum[QUORUM_LENGTH_OFFSET] == 0) return;
+  const int64_t leader = quorum[QUORUM_LEADER_OFFSET];
+  assert(leader < vectorsLength);
+  int64_t length = 0;
+  int64_t repair = 0;
+  if (quorum[QUORUM_REPAIR_OFFSET] == 0) {
+    // No replica lags the leader (always the case for the fast path), so the
+    // members are those replicas which have the same vector as the leader:
+    const uint8_t* a = vectors[leader] + vectorOffset;
+    for (int64_t index = 0; index < vectorsLength; index++) {
+      if (!quorum_equal(vectors[index] + vectorOffset, a)) continue;
+      if (members != NULL) members[index >> 3] |= 1 << (index & 7);
+      length++;
+    }
+  } else {
+    // Only the slow path can find lagging replicas, and its node records are
+    // still in scratch. Mark the leader's chain of dependencies:
+    const uint16_t* owners = (const uint16_t*) (
+      nodes + QUORUM_NODES + QUORUM_SLOTS * 2 + QUORUM_STACK * 4
     );
-    if (error) break;
-    if (quorum[QUORUM_LENGTH_OFFSET] > 0) {
-      assert(sourcesLength > 0);
-      memcpy(
-        target,
-        sources[quorum[QUORUM_LEADER_OFFSET]] + sourceOffset,
-        objectSize
-      );
-    } else {
-      memset(target, 0, objectSize);
+    int64_t nodesOffset = owners[leader];
+    while (1) {
+      nodes[nodesOffset] |= QUORUM_MEMBER;
+      if ((nodes[nodesOffset] & QUORUM_DEPENDENT) == 0) break;
+      nodesOffset = (int64_t) quorum_dependency(nodes, nodesOffset);
+    }
+    for (int64_t index = 0; index < vectorsLength; index++) {
+      if ((nodes[owners[index]] & QUORUM_MEMBER) == 0) continue;
+      if (members != NULL) members[index >> 3] |= 1 << (index & 7);
+      length++;
+      if (owners[index] == owners[leader]) continue;
+      if (lagging != NULL) lagging[index >> 3] |= 1 << (index & 7);
+      repair++;
     }
-    sourceOffset += objectSize;
-    quorum += QUORUM_SIZE;
-    target += objectSize;
   }
-  if (nodes != NULL) {
-    free(nodes);
-    nodes = NULL;
+  assert(length == quorum[QUORUM_LENGTH_OFFSET]);
+  assert(repair == quorum[QUORUM_REPAIR_OFFSET]);
+}
+
+// Moves the bits of a bitmap calculated for a subset of the replicas to the
+// indices of those replicas:
+static void quorum_bitmap_scatter(
+  uint8_t* bitmap,
+  const uint8_t* indices,
+  const int64_t length
+) {
+  if (bitmap == NULL) return;
+  uint8_t subset[QUORUM_BITMAP];
+  memcpy(subset, bitmap, QUORUM_BITMAP);
+  memset(bitmap, 0, QUORUM_BITMAP);
+  for (int64_t index = 0; index < length; index++) {
+    if ((subset[index >> 3] & (1 << (index & 7))) == 0) continue;
+    bitmap[indices[index] >> 3] |= 1 << (indices[index] & 7);
   }
-  return error;
 }
 
-struct quorum_context {
-  int64_t vectorOffset;
-  int64_t objectSize;
-  int64_t sourceSize;
-  uint8_t* sources[255];
-  int64_t sourcesLength;
-  uint8_t* quorum;
-  uint8_t* target;
-  int error;
-  napi_ref ref_sources;
-  napi_ref ref_quorum;
-  napi_ref ref_target;
-  napi_ref ref_callback;
-  napi_async_work async_work;
+// Returns the number of objects whose vectors fit in the vector table:
+static int64_t quorum_stream_objects(const int64_t sourcesLength) {
+  assert(sourcesLength >= QUORUM_SOURCES_MIN);
+  const int64_t objects = QUORUM_STREAM / (QUORUM_VECTOR * sourcesLength);
+  assert(objects >= 1);
+  return objects < QUORUM_STREAM_OBJECTS ? objects : QUORUM_STREAM_OBJECTS;
+}
+
+// Gathers the vectors of a block of objects into a structure of arrays, a row
+// for each 64-bit lane of each replica's vectors, so that the block can be
+// decided along contiguous rows. The vectors ahead, up to limit objects from
+// the first, are prefetched, since the hardware prefetcher cannot follow so
+// many sources at a stride of a large object:
+static void quorum_stream_gather(
+  uint8_t** sources,
+  const int64_t sourcesLength,
+  const int64_t vectorOffset,
+  const int64_t objectSize,
+  const int64_t objects,
+  const int64_t limit,
+  uint64_t* table
+) {
+  assert(objects >= 1);
+  assert(objects <= limit);
+  uint64_t* rows[4];
+  for (int lane = 0; lane < 4; lane++) {
+    rows[lane] = table + lane * sourcesLength * objects;
+  }
+  // Prefetch a few vectors ahead in the order of gathering, since more would
+  // compete for the same cache sets at a stride of a power of two:
+  int64_t aheadObject = QUORUM_STREAM_AHEAD / sourcesLength;
+  int64_t aheadIndex = QUORUM_STREAM_AHEAD % sourcesLength;
+  for (int64_t object = 0; object < objects; object++) {
+    const int64_t offset = vectorOffset + object * objectSize;
+    for (int64_t index = 0; index < sourcesLength; index++) {
+      if (aheadObject < limit) {
+        const uint8_t* ahead = sources[aheadIndex] + vectorOffset +
+          aheadObject * objectSize;
+        QUORUM_PREFETCH(ahead);
+        QUORUM_PREFETCH(ahead + QUORUM_VECTOR - 1);
+      }
+      if (++aheadIndex == sourcesLength) {
+        aheadIndex = 0;
+        aheadObject++;
+      }
+      uint64_t lanes[4];
+      memcpy(lanes, sources[index] + offset, QUORUM_VECTOR);
+      for (int lane = 0; lane < 4; lane++) {
+        rows[lane][index * objects + object] = lanes[lane];
+      }
+    }
+  }
+}
+
+// Decides which objects of a block are unanimous: every vector is identical to
+// the first, which does not reference itself. These have the result which
+// quorum_fast() would find, and the rest are left to quorum_fast():
+static void quorum_stream_decide(
+  const uint64_t* table,
+  const int64_t sourcesLength,
+  const int64_t objects,
+  uint8_t* unanimous
+) {
+  assert(objects <= QUORUM_STREAM_OBJECTS);
+  uint64_t difference[QUORUM_STREAM_OBJECTS];
+  memset(difference, 0, objects * sizeof(uint64_t));
+  for (int lane = 0; lane < 4; lane++) {
+    const uint64_t* first = table + lane * sourcesLength * objects;
+    for (int64_t index = 1; index < sourcesLength; index++) {
+      const uint64_t* row = first + index * objects;
+      for (int64_t object = 0; object < objects; object++) {
+        difference[object] |= row[object] ^ first[object];
+      }
+    }
+  }
+  const uint64_t* a0 = table;
+  const uint64_t* a1 = table + sourcesLength * objects;
+  const uint64_t* a2 = table + 2 * sourcesLength * objects;
+  const uint64_t* a3 = table + 3 * sourcesLength * objects;
+  for (int64_t object = 0; object < objects; object++) {
+    unanimous[object] = difference[object] == 0 && (
+      ((a0[object] ^ a2[object]) | (a1[object] ^ a3[object])) != 0
+    );
+  }
+}
+
+// Fingerprint the vectors of all replicas of an object, so that an unchanged
+// object can be detected with a single pass over its vectors. Each word of a
+// vector has its own lane, so that the multiplies are independent:
+static uint64_t quorum_fingerprint(
+  uint8_t** vectors,
+  const int64_t vectorsLength,
+  const int64_t vectorOffset
+) {
+  assert(QUORUM_VECTOR == 4 * sizeof(uint64_t));
+  uint64_t lanes[4] = {
+    0x9E3779B97F4A7C15ULL ^ (uint64_t) vectorsLength,
+    0xC2B2AE3D27D4EB4FULL,
+    0x165667B19E3779F9ULL,
+    0x27D4EB2F165667C5ULL
+  };
+  for (int64_t index = 0; index < vectorsLength; index++) {
+    uint64_t words[4];
+    memcpy(words, vectors[index] + vectorOffset, QUORUM_VECTOR);
+    for (int lane = 0; lane < 4; lane++) {
+      lanes[lane] = (lanes[lane] ^ words[lane]) * 0xFF51AFD7ED558CCDULL;
+      lanes[lane] ^= lanes[lane] >> 29;
+    }
+  }
+  uint64_t hash = lanes[0];
+  for (int lane = 1; lane < 4; lane++) {
+    hash = (hash ^ lanes[lane]) * 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 32;
+  }
+  // Zero is reserved for an empty cache entry:
+  return hash == 0 ? 1 : hash;
+}
+
+// The slow path for calculateWide(), for which the fixed scratch of the slow
+// path is too small and a linear scan of nodes would be quadratic. Nodes are
+// always indexed by a hash of their ID:
+struct quorum_wide_node {
+  uint8_t id[QUORUM_ID];
+  uint32_t dependency; // Index of the node this node depends on.
+  uint16_t index; // Index of the first vector with this ID.
+  uint16_t length;
+  uint16_t repair;
+  uint8_t flags;
+};
+
+struct quorum_wide_result {
+  int64_t leader;
+  int64_t length;
+  int64_t repair;
+  int forked;
+};
+
+struct quorum_wide_scratch {
+  struct quorum_wide_node* nodes; // At most two for each vector.
+  uint32_t* slots; // Node index + 1, or 0 if empty.
+  int64_t slotsMask;
+  uint32_t* stack;
+};
+
+static int quorum_wide_scratch_init(
+  struct quorum_wide_scratch* scratch,
+  const int64_t vectorsLength
+) {
+  int64_t slots = 4;
+  while (slots < vectorsLength * 4) slots *= 2;
+  scratch->nodes = malloc(2 * vectorsLength * sizeof(struct quorum_wide_node));
+  scratch->slots = malloc(slots * sizeof(uint32_t));
+  scratch->slotsMask = slots - 1;
+  scratch->stack = malloc(2 * vectorsLength * sizeof(uint32_t));
+  return (
+    scratch->nodes != NULL &&
+    scratch->slots != NULL &&
+    scratch->stack != NULL
+  );
+}
+
+static void quorum_wide_scratch_free(struct quorum_wide_scratch* scratch) {
+  if (scratch->nodes != NULL) free(scratch->nodes);
+  if (scratch->slots != NULL) free(scratch->slots);
+  if (scratch->stack != NULL) free(scratch->stack);
+}
+
+static inline uint32_t quorum_wide_node(
+  struct quorum_wide_scratch* scratch,
+  uint32_t* nodesLength,
+  const uint8_t* id
+) {
+  int64_t slot = quorum_hash(id) & scratch->slotsMask;
+  while (scratch->slots[slot] != 0) {
+    const uint32_t node = scratch->slots[slot] - 1;
+    if (quorum_equal(scratch->nodes[node].id, id)) return node;
+    slot = (slot + 1) & scratch->slotsMask;
+  }
+  const uint32_t node = (*nodesLength)++;
+  scratch->slots[slot] = node + 1;
+  memcpy(scratch->nodes[node].id, id, QUORUM_ID);
+  scratch->nodes[node].index = 0;
+  scratch->nodes[node].length = 0;
+  scratch->nodes[node].repair = 0;
+  scratch->nodes[node].flags = 0;
+  return node;
+}
+
+static int quorum_wide_visit(
+  struct quorum_wide_scratch* scratch,
+  uint32_t node,
+  struct quorum_wide_result* result
+) {
+  struct quorum_wide_node* nodes = scratch->nodes;
+  int64_t stackLength = 0;
+  uint16_t count = 0;
+  while (1) {
+    if (nodes[node].flags & QUORUM_PERMANENT) {
+      count = nodes[node].length;
+      break;
+    }
+    if (nodes[node].flags & QUORUM_TEMPORARY) return 1;
+    nodes[node].flags |= QUORUM_TEMPORARY;
+    scratch->stack[stackLength++] = node;
+    if ((nodes[node].flags & QUORUM_DEPENDENT) == 0) break;
+    node = nodes[node].dependency;
+  }
+  while (stackLength > 0) {
+    node = scratch->stack[--stackLength];
+    if (nodes[node].flags & QUORUM_DEPENDENT) {
+      nodes[node].repair = count;
+      assert(nodes[node].length + nodes[node].repair <= UINT16_MAX);
+      nodes[node].length += nodes[node].repair;
+    }
+    nodes[node].flags |= QUORUM_PERMANENT;
+    if (result->length < nodes[node].length) {
+      result->leader = nodes[node].index;
+      result->length = nodes[node].length;
+      result->repair = nodes[node].repair;
+      result->forked = 0;
+    } else if (result->length == nodes[node].length) {
+      result->forked = 1;
+    }
+    count = nodes[node].length;
+  }
+  return 0;
+}
+
+static int quorum_wide(
+  uint8_t** vectors,
+  const int64_t vectorsLength,
+  const int64_t vectorOffset,
+  struct quorum_wide_scratch* scratch,
+  struct quorum_wide_result* result
+) {
+  assert(vectorsLength >= QUORUM_SOURCES_MIN);
+  assert(vectorsLength <= QUORUM_SOURCES_WIDE_MAX);
+  result->leader = 0;
+  result->length = 0;
+  result->repair = 0;
+  result->forked = 0;
+  // Most objects agree, which needs only a pass over the vectors:
+  const uint8_t* a = vectors[0] + vectorOffset;
+  if (quorum_equal(a, a + QUORUM_ID)) return 1;
+  int64_t agree = 1;
+  while (
+    agree < vectorsLength &&
+    quorum_equal(vectors[agree] + vectorOffset, a) &&
+    quorum_equal(vectors[agree] + vectorOffset + QUORUM_ID, a + QUORUM_ID)
+  ) {
+    agree++;
+  }
+  if (agree == vectorsLength) {
+    result->length = vectorsLength;
+    return 0;
+  }
+  memset(scratch->slots, 0, (scratch->slotsMask + 1) * sizeof(uint32_t));
+  uint32_t nodesLength = 0;
+  for (int64_t index = 0; index < vectorsLength; index++) {
+    const uint8_t* vector = vectors[index] + vectorOffset;
+    const uint32_t node = quorum_wide_node(scratch, &nodesLength, vector);
+    struct quorum_wide_node* owner = &scratch->nodes[node];
+    if (owner->length++ == 0) owner->index = (uint16_t) index;
+    if (owner->flags & QUORUM_DEPENDENT) continue;
+    // The first vector with an ID describes its dependency:
+    const uint32_t dependency = quorum_wide_node(
+      scratch,
+      &nodesLength,
+      vector + QUORUM_ID
+    );
+    scratch->nodes[node].flags |= QUORUM_DEPENDENT;
+    scratch->nodes[node].dependency = dependency;
+  }
+  assert(nodesLength <= 2 * vectorsLength);
+  for (uint32_t node = 0; node < nodesLength; node++) {
+    const uint8_t flags = scratch->nodes[node].flags;
+    if (flags & (QUORUM_TEMPORARY | QUORUM_PERMANENT)) continue;
+    if (quorum_wide_visit(scratch, node, result)) return 1;
+  }
+  if (result->forked) {
+    result->leader = 0;
+    result->length = 0;
+    result->repair = 0;
+  }
+  return 0;
+}
+
+struct quorum_extent {
+  int64_t begin; // Index of the first object, counting across all extents.
+  int64_t end;
+  int64_t sourceOffset;
+  int64_t targetOffset; // Used only if the target is segmented.
+  uint8_t* quorum;
+  uint8_t* target;
+};
+
+// Entries of options.sparse, for objects which are not unanimous. Length
+// counts every such object, even beyond the capacity of the entries:
+struct quorum_sparse {
+  uint8_t* entries;
+  int64_t capacity;
+  int64_t length;
+};
+
+static inline void quorum_sparse_append(
+  struct quorum_sparse* sparse,
+  const int64_t object,
+  const uint8_t* quorum
+) {
+  if (sparse->length < sparse->capacity) {
+    uint8_t* entry = sparse->entries + sparse->length * QUORUM_SPARSE;
+    assert(object >= 0);
+    assert(object <= UINT32_MAX);
+    for (int index = 0; index < 4; index++) {
+      entry[index] = (uint8_t) (object >> (index * 8));
+    }
+    memcpy(entry + 4, quorum, QUORUM_SIZE);
+  }
+  sparse->length++;
+}
+
+// A buffer segment at an offset within the logical source or target:
+struct quorum_segment {
+  uint8_t* base;
+  int64_t offset;
+  int64_t length;
+};
+
+struct quorum_context {
+  int64_t vectorOffset;
+  int64_t objectSize;
+  uint8_t* sources[255];
+  uint8_t** wideSources; // Sources of calculateWide(), too many for sources.
+  int64_t sourcesLength;
+  uint8_t* quorum;
+  uint8_t* target;
+  const uint8_t* descriptors; // Extent descriptors, only until dispatch.
+  struct quorum_extent* extents;
+  int64_t extentsLength;
+  struct quorum_extent extent; // Avoids an allocation for a single extent.
+  int64_t objects;
+  int64_t begin; // Range of objects to execute, a chunk at a time if async.
+  int64_t end;
+  int64_t chunk; // Objects per async work item, or 0 for a single item.
+  int stream; // Gather and decide vectors a block of objects at a time.
+  int files; // Sources are read from fds, a window of objects at a time.
+  int wide; // calculateWide(), with a wide result for each object.
+  int segmented; // Sources or target are arrays of buffer segments.
+  int targetSegmented;
+  struct quorum_segment* segments; // Each source's segments, then target's.
+  int64_t segmentsIndex[256 + 1]; // First segment of each list, and the end.
+  uv_file fds[255];
+  int64_t window;
+  int64_t depth; // Windows of reads in flight for each file.
+  int uring; // Read files through io_uring where available.
+  uint8_t* rewritten; // Bitmap of the replicas rewritten by repair per object.
+  uint8_t* leaders;
+  uint8_t* members;
+  uint8_t* lagging;
+  uint8_t* repaired;
+  uint8_t* cache; // Fingerprint of each object as of its last calculation.
+  uint8_t* changed; // Whether the result of each object has changed.
+  double* stats; // Counters added to across calls (see QUORUM_STATS).
+  struct quorum_sparse sparse; // Across async chunks, if entries != NULL.
+  int64_t sparseBase; // Index of object 0 in options.sparse entries.
+  int64_t checksum; // Offset of each object's CRC32C, or -1 if unverified.
+  uint8_t* rejected; // Replicas which failed their checksum, for each object.
+  int64_t threads;
+  int error;
+  napi_ref ref_sources;
+  napi_ref ref_quorum;
+  napi_ref ref_target;
+  napi_ref ref_leaders;
+  napi_ref ref_members;
+  napi_ref ref_lagging;
+  napi_ref ref_repaired;
+  napi_ref ref_cache;
+  napi_ref ref_changed;
+  napi_ref ref_stats;
+  napi_ref ref_sparse;
+  napi_ref ref_rejected;
+  napi_ref ref_progress;
+  napi_ref ref_signal;
+  napi_ref ref_callback;
+  napi_async_work async_work;
 };
 
-napi_value quorum_error(napi_env env, int error) {
-  assert(error != 0);
-  assert(error == 1);
-  napi_value code;
-  napi_value message;
-  napi_value result;
+// Scratch buffers and async contexts are recycled instead of being allocated
+// for every call, since small calls are dominated by their fixed costs:
+struct quorum_pool {
+  size_t size;
+  int64_t length;
+  void* items[QUORUM_POOL];
+};
+
+static uv_once_t quorum_pool_once = UV_ONCE_INIT;
+static uv_mutex_t quorum_pool_mutex;
+static uv_mutex_t quorum_stats_mutex;
+static struct quorum_pool quorum_scratch_pool = { QUORUM_SCRATCH, 0, { 0 } };
+// Only options.stream needs the vector table, so that other calls keep to
+// the smaller scratch buffer:
+static struct quorum_pool quorum_stream_pool = { QUORUM_STREAM, 0, { 0 } };
+static struct quorum_pool quorum_context_pool = {
+  sizeof(struct quorum_context),
+  0,
+  { 0 }
+};
+
+static void quorum_pool_init(void) {
+  assert(uv_mutex_init(&quorum_pool_mutex) == 0);
+  assert(uv_mutex_init(&quorum_stats_mutex) == 0);
+}
+
+static void* quorum_pool_acquire(struct quorum_pool* pool) {
+  void* item = NULL;
+  uv_mutex_lock(&quorum_pool_mutex);
+  assert(pool->length >= 0);
+  assert(pool->length <= QUORUM_POOL);
+  if (pool->length > 0) item = pool->items[--pool->length];
+  uv_mutex_unlock(&quorum_pool_mutex);
+  if (item == NULL) item = malloc(pool->size);
+  return item;
+}
+
+static void quorum_pool_release(struct quorum_pool* pool, void* item) {
+  assert(item != NULL);
+  uv_mutex_lock(&quorum_pool_mutex);
+  if (pool->length < QUORUM_POOL) {
+    pool->items[pool->length++] = item;
+    item = NULL;
+  }
+  uv_mutex_unlock(&quorum_pool_mutex);
+  if (item != NULL) free(item);
+}
+
+static int quorum_iterate(
+  const struct quorum_context* ctx,
+  const int64_t begin,
+  const int64_t end,
+  struct quorum_sparse* sparse
+) {
+  const int64_t vectorOffset = ctx->vectorOffset;
+  const int64_t objectSize = ctx->objectSize;
+  uint8_t** sources = (uint8_t**) ctx->sources;
+  const int64_t sourcesLength = ctx->sourcesLength;
+  assert(vectorOffset >= 0);
+  assert(objectSize >= 0);
+  assert(objectSize >= vectorOffset + QUORUM_VECTOR);
+  assert(begin >= 0);
+  assert(begin <= end);
+  assert(end <= ctx->objects);
+  assert(sourcesLength >= QUORUM_SOURCES_MIN);
+  assert(sourcesLength <= QUORUM_SOURCES_MAX);
+  assert(sourcesLength <= UINT8_MAX);
+  assert(sourcesLength <= 255);
+  uint8_t* nodes = quorum_pool_acquire(&quorum_scratch_pool);
+  assert(nodes != NULL);
+  // Receives the result of each object if the caller omits the quorum buffer:
+  uint8_t result[QUORUM_SIZE];
+  const quorum_fast_kernel fast = quorum_fast_select(sourcesLength);
+  // Counters are kept locally and added to options.stats once at the end:
+  uint64_t counters[QUORUM_STATS];
+  uint64_t* stats = NULL;
+  if (ctx->stats != NULL) {
+    memset(counters, 0, sizeof(counters));
+    stats = counters;
+  }
+  // Find the extent of the first object, since a range may begin anywhere:
+  const struct quorum_extent* extent = ctx->extents;
+  int64_t low = 0;
+  int64_t high = ctx->extentsLength - 1;
+  while (low < high) {
+    const int64_t middle = low + (high - low + 1) / 2;
+    if (ctx->extents[middle].begin <= begin) {
+      low = middle;
+    } else {
+      high = middle - 1;
+    }
+  }
+  extent += low;
+  // With options.checksum, the vectors of verified replicas, their sources,
+  // and a bit for each replica which failed its checksum:
+  uint8_t* verified[QUORUM_SOURCES_MAX];
+  uint8_t indices[QUORUM_SOURCES_MAX];
+  uint8_t corrupt[QUORUM_BITMAP];
+  // With options.stream, the vectors of a block of objects are gathered into
+  // a table, and each object found unanimous there skips quorum_fast():
+  uint64_t* table = NULL;
+  uint8_t unanimous[QUORUM_STREAM_OBJECTS];
+  int64_t streamBegin = begin;
+  int64_t streamEnd = begin;
+  const int64_t streamObjects = quorum_stream_objects(sourcesLength);
+  if (ctx->stream) {
+    table = quorum_pool_acquire(&quorum_stream_pool);
+    assert(table != NULL);
+  }
+  int error = 0;
+  for (int64_t object = begin; object < end; object++) {
+    while (object >= extent->end) extent++;
+    assert(object >= extent->begin);
+    const int64_t local = object - extent->begin;
+    const int64_t sourceOffset = extent->sourceOffset + local * objectSize;
+    uint8_t* quorum = result;
+    if (extent->quorum != NULL) quorum = extent->quorum + local * QUORUM_SIZE;
+    const int64_t vectorsOffset = sourceOffset + vectorOffset;
+    if (table != NULL && object == streamEnd) {
+      // A block never crosses an extent, since extents need not be contiguous:
+      const int64_t limit = end < extent->end ? end : extent->end;
+      streamBegin = object;
+      streamEnd = object + streamObjects < limit ?
+        object + streamObjects : limit;
+      quorum_stream_gather(
+        sources,
+        sourcesLength,
+        vectorsOffset,
+        objectSize,
+        streamEnd - streamBegin,
+        limit - streamBegin,
+        table
+      );
+      quorum_stream_decide(
+        table,
+        sourcesLength,
+        streamEnd - streamBegin,
+        unanimous
+      );
+    }
+    // With options.cache, an object whose vectors have the same fingerprint
+    // as before keeps its previous quorum, members and lagging results:
+    uint8_t* cache = NULL;
+    uint64_t fingerprint = 0;
+    uint64_t cached = 0;
+    if (ctx->cache != NULL) {
+      assert(extent->quorum != NULL);
+      cache = ctx->cache + object * QUORUM_CACHE;
+      fingerprint = quorum_fingerprint(sources, sourcesLength, vectorsOffset);
+      memcpy(&cached, cache, QUORUM_CACHE);
+    }
+    // Replicas which fail their checksum are dropped before their vectors
+    // are compared, in the same pass, while each object is still in cache:
+    int64_t rejected = 0;
+    if (ctx->checksum >= 0) {
+      quorum_verify(
+        sources,
+        sourcesLength,
+        sourceOffset,
+        objectSize,
+        ctx->checksum,
+        corrupt
+      );
+      for (int64_t index = 0; index < sourcesLength; index++) {
+        if (corrupt[index >> 3] & (1 << (index & 7))) {
+          rejected++;
+        } else {
+          verified[index - rejected] = sources[index];
+          indices[index - rejected] = (uint8_t) index;
+        }
+      }
+      if (ctx->rejected != NULL) ctx->rejected[object] = (uint8_t) rejected;
+    }
+    if (cache == NULL || cached != fingerprint) {
+      uint8_t previous[QUORUM_SIZE];
+      memcpy(previous, quorum, QUORUM_SIZE);
+      int path = QUORUM_STATS_FAST;
+      const uint64_t time = stats != NULL ? uv_hrtime() : 0;
+      if (rejected == 0 && table != NULL && unanimous[object - streamBegin]) {
+        quorum[QUORUM_LEADER_OFFSET] = 0;
+        quorum[QUORUM_LENGTH_OFFSET] = (uint8_t) sourcesLength;
+        quorum[QUORUM_REPAIR_OFFSET] = 0;
+        quorum[QUORUM_FORKED_OFFSET] = 0;
+      } else if (rejected == 0) {
+        error = fast(
+          sources,
+          sourcesLength,
+          vectorsOffset,
+          nodes,
+          quorum,
+          &path
+        );
+      } else if (rejected < sourcesLength) {
+        error = quorum_fast(
+          verified,
+          sourcesLength - rejected,
+          vectorsOffset,
+          nodes,
+          quorum,
+          &path
+        );
+      } else {
+        // No replica is left to form a quorum:
+        memset(quorum, 0, QUORUM_SIZE);
+      }
+      if (stats != NULL) {
+        const uint64_t elapsed = uv_hrtime() - time;
+        if (error) {
+          stats[QUORUM_STATS_CYCLIC]++;
+        } else {
+          stats[path]++;
+        }
+        if (path == QUORUM_STATS_FAST) {
+          stats[QUORUM_STATS_FAST_NS] += elapsed;
+        } else {
+          stats[QUORUM_STATS_SLOW_NS] += elapsed;
+        }
+      }
+      if (error) break;
+      if (ctx->members != NULL || ctx->lagging != NULL) {
+        uint8_t* members = ctx->members != NULL ?
+          ctx->members + object * QUORUM_BITMAP : NULL;
+        uint8_t* lagging = ctx->lagging != NULL ?
+          ctx->lagging + object * QUORUM_BITMAP : NULL;
+        if (rejected == 0) {
+          quorum_members(
+            sources,
+            sourcesLength,
+            vectorsOffset,
+            nodes,
+            quorum,
+            members,
+            lagging
+          );
+        } else if (rejected < sourcesLength) {
+          quorum_members(
+            verified,
+            sourcesLength - rejected,
+            vectorsOffset,
+            nodes,
+            quorum,
+            members,
+            lagging
+          );
+          quorum_bitmap_scatter(members, indices, sourcesLength - rejected);
+          quorum_bitmap_scatter(lagging, indices, sourcesLength - rejected);
+        } else {
+          if (members != NULL) memset(members, 0, QUORUM_BITMAP);
+          if (lagging != NULL) memset(lagging, 0, QUORUM_BITMAP);
+        }
+      }
+      // The leader was an index into the verified replicas:
+      if (rejected > 0 && quorum[QUORUM_LENGTH_OFFSET] > 0) {
+        assert(quorum[QUORUM_LEADER_OFFSET] < sourcesLength - rejected);
+        quorum[QUORUM_LEADER_OFFSET] = indices[quorum[QUORUM_LEADER_OFFSET]];
+      }
+      if (ctx->changed != NULL) {
+        ctx->changed[object] = memcmp(previous, quorum, QUORUM_SIZE) != 0;
+      }
+    } else {
+      if (ctx->changed != NULL) ctx->changed[object] = 0;
+      if (stats != NULL) stats[QUORUM_STATS_CACHED]++;
+    }
+    // Results are counted for every object, however they were calculated:
+    if (stats != NULL) {
+      if (quorum[QUORUM_FORKED_OFFSET]) stats[QUORUM_STATS_FORKED]++;
+      stats[QUORUM_STATS_LENGTH + quorum[QUORUM_LENGTH_OFFSET]]++;
+      stats[QUORUM_STATS_REPAIR + quorum[QUORUM_REPAIR_OFFSET]]++;
+    }
+    // The target copy often costs more than the quorum, so it is optional:
+    if (extent->target != NULL) {
+      uint8_t* target = extent->target + local * objectSize;
+      if (quorum[QUORUM_LENGTH_OFFSET] > 0) {
+        assert(sourcesLength > 0);
+        memcpy(
+          target,
+          sources[quorum[QUORUM_LEADER_OFFSET]] + sourceOffset,
+          objectSize
+        );
+      } else {
+        memset(target, 0, objectSize);
+      }
+    }
+    if (ctx->leaders != NULL) {
+      ctx->leaders[object] = quorum[QUORUM_LENGTH_OFFSET] > 0 ?
+        quorum[QUORUM_LEADER_OFFSET] : QUORUM_LEADER_NONE;
+    }
+    // A forked object has a LENGTH of 0, so is never unanimous:
+    if (
+      sparse != NULL &&
+      (
+        quorum[QUORUM_LENGTH_OFFSET] != sourcesLength ||
+        quorum[QUORUM_REPAIR_OFFSET] != 0
+      )
+    ) {
+      quorum_sparse_append(sparse, ctx->sparseBase + object, quorum);
+    }
+    // Repair last, since every other output is derived from the vectors:
+    if (ctx->repaired != NULL) {
+      uint8_t repaired = 0;
+      if (quorum[QUORUM_LENGTH_OFFSET] > 0) {
+        const int64_t leader = quorum[QUORUM_LEADER_OFFSET];
+        const uint8_t* a = sources[leader] + sourceOffset;
+        for (int64_t index = 0; index < sourcesLength; index++) {
+          if (index == leader) continue;
+          uint8_t* b = sources[index] + sourceOffset;
+          // Replicas with the same leading ID as the leader already agree,
+          // unless their object failed its checksum:
+          if (
+            quorum_equal(b + vectorOffset, a + vectorOffset) &&
+            (rejected == 0 || (corrupt[index >> 3] & (1 << (index & 7))) == 0)
+          ) {
+            continue;
+          }
+          memcpy(b, a, objectSize);
+          repaired++;
+          if (ctx->rewritten != NULL) {
+            ctx->rewritten[object * QUORUM_BITMAP + (index >> 3)] |= (
+              1 << (index & 7)
+            );
+          }
+        }
+      }
+      ctx->repaired[object] = repaired;
+      // The quorum of a repaired object must be calculated again next time:
+      if (repaired > 0) fingerprint = 0;
+    }
+    if (cache != NULL) memcpy(cache, &fingerprint, QUORUM_CACHE);
+  }
+  if (stats != NULL) {
+    // Threads share options.stats:
+    uv_mutex_lock(&quorum_stats_mutex);
+    for (int index = 0; index < QUORUM_STATS; index++) {
+      if (stats[index] > 0) ctx->stats[index] += (double) stats[index];
+    }
+    uv_mutex_unlock(&quorum_stats_mutex);
+  }
+  if (nodes != NULL) {
+    quorum_pool_release(&quorum_scratch_pool, nodes);
+    nodes = NULL;
+  }
+  if (table != NULL) {
+    quorum_pool_release(&quorum_stream_pool, table);
+    table = NULL;
+  }
+  return error;
+}
+
+static inline void quorum_write_uint16(uint8_t* buffer, int64_t value) {
+  assert(value >= 0);
+  assert(value <= UINT16_MAX);
+  buffer[0] = (uint8_t) value;
+  buffer[1] = (uint8_t) (value >> 8);
+}
+
+static int quorum_iterate_wide(
+  const struct quorum_context* ctx,
+  const int64_t begin,
+  const int64_t end
+) {
+  const int64_t vectorOffset = ctx->vectorOffset;
+  const int64_t objectSize = ctx->objectSize;
+  uint8_t** sources = ctx->wideSources;
+  const int64_t sourcesLength = ctx->sourcesLength;
+  assert(sources != NULL);
+  assert(ctx->extentsLength == 1);
+  assert(begin >= 0);
+  assert(begin <= end);
+  assert(end <= ctx->objects);
+  const struct quorum_extent* extent = ctx->extents;
+  struct quorum_wide_scratch scratch;
+  if (!quorum_wide_scratch_init(&scratch, sourcesLength)) {
+    quorum_wide_scratch_free(&scratch);
+    return UV_ENOMEM;
+  }
+  int error = 0;
+  for (int64_t object = begin; object < end; object++) {
+    const int64_t sourceOffset = extent->sourceOffset + object * objectSize;
+    struct quorum_wide_result result;
+    error = quorum_wide(
+      sources,
+      sourcesLength,
+      sourceOffset + vectorOffset,
+      &scratch,
+      &result
+    );
+    if (error) break;
+    if (extent->quorum != NULL) {
+      uint8_t* quorum = extent->quorum + object * QUORUM_WIDE_SIZE;
+      quorum_write_uint16(quorum + QUORUM_WIDE_LEADER_OFFSET, result.leader);
+      quorum_write_uint16(quorum + QUORUM_WIDE_LENGTH_OFFSET, result.length);
+      quorum_write_uint16(quorum + QUORUM_WIDE_REPAIR_OFFSET, result.repair);
+      quorum[QUORUM_WIDE_FORKED_OFFSET] = (uint8_t) result.forked;
+      quorum[QUORUM_WIDE_FORKED_OFFSET + 1] = 0;
+    }
+    if (extent->target != NULL) {
+      uint8_t* target = extent->target + object * objectSize;
+      if (result.length > 0) {
+        memcpy(target, sources[result.leader] + sourceOffset, objectSize);
+      } else {
+        memset(target, 0, objectSize);
+      }
+    }
+  }
+  quorum_wide_scratch_free(&scratch);
+  return error;
+}
+
+static int quorum_range(
+  const struct quorum_context* ctx,
+  const int64_t begin,
+  const int64_t end,
+  struct quorum_sparse* sparse
+) {
+  if (ctx->wide) {
+    assert(sparse == NULL);
+    return quorum_iterate_wide(ctx, begin, end);
+  }
+  return quorum_iterate(ctx, begin, end, sparse);
+}
+
+struct quorum_worker {
+  const struct quorum_context* ctx;
+  int64_t begin;
+  int64_t end;
+  struct quorum_sparse sparse; // Merged in order of range when joined.
+  struct quorum_sparse* output; // NULL if options.sparse was not given.
+  int error;
+  uv_thread_t thread;
+};
+
+static void quorum_worker_execute(void* data) {
+  struct quorum_worker* worker = data;
+  worker->error = quorum_range(
+    worker->ctx,
+    worker->begin,
+    worker->end,
+    worker->output != NULL ? &worker->sparse : NULL
+  );
+}
+
+static int quorum_execute_sources(
+  const struct quorum_context* ctx,
+  struct quorum_sparse* sparse
+) {
+  assert(ctx->objectSize > 0);
+  assert(ctx->threads >= 1);
+  assert(ctx->threads <= QUORUM_THREADS_MAX);
+  assert(ctx->begin >= 0);
+  assert(ctx->begin <= ctx->end);
+  assert(ctx->end <= ctx->objects);
+  const int64_t objects = ctx->end - ctx->begin;
+  // Objects are independent, and each thread writes to a disjoint range of
+  // quorum and target, but a thread must have enough objects to be worth it:
+  int64_t threads = ctx->threads;
+  if (threads > objects / QUORUM_THREAD_OBJECTS) {
+    threads = objects / QUORUM_THREAD_OBJECTS;
+  }
+  if (threads <= 1) return quorum_range(ctx, ctx->begin, ctx->end, sparse);
+  // Each range keeps its own sparse entries, up to the space remaining, so
+  // that the entries kept are those of the first objects, as for one thread:
+  int64_t remaining = 0;
+  if (sparse != NULL && sparse->length < sparse->capacity) {
+    remaining = sparse->capacity - sparse->length;
+  }
+  struct quorum_worker workers[QUORUM_THREADS_MAX];
+  int64_t object = ctx->begin;
+  int error = 0;
+  for (int64_t index = 0; index < threads; index++) {
+    // Spread any remainder across the first threads:
+    int64_t length = objects / threads + (index < objects % threads ? 1 : 0);
+    struct quorum_worker* worker = &workers[index];
+    worker->ctx = ctx;
+    worker->begin = object;
+    worker->end = object + length;
+    worker->output = sparse;
+    worker->sparse.entries = NULL;
+    worker->sparse.capacity = length < remaining ? length : remaining;
+    worker->sparse.length = 0;
+    if (worker->sparse.capacity > 0) {
+      worker->sparse.entries = malloc(worker->sparse.capacity * QUORUM_SPARSE);
+      if (worker->sparse.entries == NULL) error = UV_ENOMEM;
+    }
+    worker->error = 0;
+    object += length;
+  }
+  assert(object == ctx->end);
+  if (error) {
+    for (int64_t index = 0; index < threads; index++) {
+      if (workers[index].sparse.entries) free(workers[index].sparse.entries);
+    }
+    return error;
+  }
+  // The calling thread executes the last range itself:
+  int64_t created = 0;
+  while (created < threads - 1) {
+    error = uv_thread_create(
+      &workers[created].thread,
+      quorum_worker_execute,
+      &workers[created]
+    );
+    if (error) break;
+    created++;
+  }
+  if (error) {
+    // Threads may be exhausted, so fail rather than abort, once the threads
+    // already created have finished with the context:
+    for (int64_t index = 0; index < created; index++) {
+      assert(uv_thread_join(&workers[index].thread) == 0);
+    }
+    for (int64_t index = 0; index < threads; index++) {
+      if (workers[index].sparse.entries) free(workers[index].sparse.entries);
+    }
+    return error;
+  }
+  quorum_worker_execute(&workers[threads - 1]);
+  error = workers[threads - 1].error;
+  for (int64_t index = 0; index < threads - 1; index++) {
+    assert(uv_thread_join(&workers[index].thread) == 0);
+    // A range stops at its first cyclic reference, but other ranges continue:
+    if (workers[index].error) error = workers[index].error;
+  }
+  for (int64_t index = 0; index < threads; index++) {
+    struct quorum_sparse* local = &workers[index].sparse;
+    if (sparse != NULL) {
+      int64_t kept = local->length < local->capacity ?
+        local->length : local->capacity;
+      if (kept > sparse->capacity - sparse->length) {
+        kept = sparse->capacity - sparse->length;
+      }
+      if (kept > 0) {
+        memcpy(
+          sparse->entries + sparse->length * QUORUM_SPARSE,
+          local->entries,
+          kept * QUORUM_SPARSE
+        );
+      }
+      sparse->length += local->length;
+    }
+    if (local->entries != NULL) free(local->entries);
+  }
+  return error;
+}
+
+static int quorum_transfer(
+  uv_file fd,
+  uint8_t* buffer,
+  int64_t length,
+  int64_t offset,
+  const int write
+) {
+  assert(length <= QUORUM_WINDOW_MAX);
+  while (length > 0) {
+    uv_fs_t req;
+    uv_buf_t buf = uv_buf_init((char*) buffer, (unsigned int) length);
+    // Without a callback, uv_fs_read() and uv_fs_write() are synchronous:
+    int result = write ?
+      uv_fs_write(NULL, &req, fd, &buf, 1, offset, NULL) :
+      uv_fs_read(NULL, &req, fd, &buf, 1, offset, NULL);
+    uv_fs_req_cleanup(&req);
+    if (result < 0) return result;
+    if (result == 0) return write ? UV_EIO : UV_EOF;
+    buffer += result;
+    length -= result;
+    offset += result;
+  }
+  return 0;
+}
+
+struct quorum_io_slot;
+
+// A read of a window of one file, or a write of a run of repaired objects:
+struct quorum_io_request {
+  struct quorum_io_request* next;
+  struct quorum_io_slot* slot;
+  uv_file fd;
+  int write;
+  uint8_t* buffer;
+  int64_t length;
+  int64_t offset;
+  int error;
+#if defined(QUORUM_URING)
+  struct iovec iov;
+#endif
+};
+
+// A window of objects of every file, with its reads and any repair writes:
+struct quorum_io_slot {
+  int64_t object;
+  int64_t length;
+  int64_t pending; // Requests in flight.
+  int error;
+  uint8_t* buffer;
+  uint8_t* rewritten;
+  struct quorum_io_request* reads;
+};
+
+// Requests are queued to io_uring, or to a pool of threads which pread() and
+// pwrite(), if io_uring is not available (or not allowed, e.g. by seccomp):
+struct quorum_io {
+  int uring;
+  struct quorum_io_request* head; // Queued, but not yet submitted.
+  struct quorum_io_request* tail;
+  struct quorum_io_request* done; // Completed, but not yet reaped.
+#if defined(QUORUM_URING)
+  int ring;
+  uint8_t* sq;
+  size_t sqSize;
+  uint8_t* cq;
+  size_t cqSize;
+  struct io_uring_sqe* sqes;
+  size_t sqesSize;
+  unsigned* sqHead;
+  unsigned* sqTail;
+  unsigned* sqArray;
+  unsigned sqMask;
+  unsigned* cqHead;
+  unsigned* cqTail;
+  unsigned cqMask;
+  struct io_uring_cqe* cqes;
+  unsigned entries;
+  unsigned inflight; // At most entries, so that the CQ never overflows.
+  unsigned queued; // Submission queue entries not yet entered.
+  int failed; // io_uring_enter() failed, so every request fails with this.
+#endif
+  uv_mutex_t mutex;
+  uv_cond_t work;
+  uv_cond_t completed;
+  uv_thread_t threads[QUORUM_IO_THREADS];
+  int64_t threadsLength;
+  int stop;
+};
+
+static void quorum_io_push(
+  struct quorum_io* io,
+  struct quorum_io_request* request
+) {
+  request->next = NULL;
+  if (io->tail != NULL) {
+    io->tail->next = request;
+  } else {
+    io->head = request;
+  }
+  io->tail = request;
+}
+
+static struct quorum_io_request* quorum_io_shift(struct quorum_io* io) {
+  struct quorum_io_request* request = io->head;
+  if (request == NULL) return NULL;
+  io->head = request->next;
+  if (io->head == NULL) io->tail = NULL;
+  request->next = NULL;
+  return request;
+}
+
+#if defined(QUORUM_URING)
+static void quorum_uring_free(struct quorum_io* io) {
+  if (io->sqes != NULL) munmap(io->sqes, io->sqesSize);
+  if (io->cq != NULL && io->cq != io->sq) munmap(io->cq, io->cqSize);
+  if (io->sq != NULL) munmap(io->sq, io->sqSize);
+  if (io->ring >= 0) close(io->ring);
+  io->sqes = NULL;
+  io->cq = NULL;
+  io->sq = NULL;
+  io->ring = -1;
+}
+
+static int quorum_uring_init(struct quorum_io* io, const int64_t requests) {
+  unsigned entries = 1;
+  while (entries < requests && entries < QUORUM_URING_ENTRIES) entries *= 2;
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  io->sq = NULL;
+  io->cq = NULL;
+  io->sqes = NULL;
+  io->ring = (int) syscall(__NR_io_uring_setup, entries, &params);
+  if (io->ring < 0) return -errno;
+  io->sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  io->cqSize = params.cq_off.cqes +
+    params.cq_entries * sizeof(struct io_uring_cqe);
+  // Kernels since 5.4 map both rings with a single mmap():
+  const int single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single) {
+    if (io->cqSize > io->sqSize) io->sqSize = io->cqSize;
+    io->cqSize = io->sqSize;
+  }
+  void* sq = mmap(
+    NULL,
+    io->sqSize,
+    PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE,
+    io->ring,
+    IORING_OFF_SQ_RING
+  );
+  if (sq == MAP_FAILED) {
+    quorum_uring_free(io);
+    return UV_ENOMEM;
+  }
+  io->sq = sq;
+  if (single) {
+    io->cq = io->sq;
+  } else {
+    void* cq = mmap(
+      NULL,
+      io->cqSize,
+      PROT_READ | PROT_WRITE,
+      MAP_SHARED | MAP_POPULATE,
+      io->ring,
+      IORING_OFF_CQ_RING
+    );
+    if (cq == MAP_FAILED) {
+      quorum_uring_free(io);
+      return UV_ENOMEM;
+    }
+    io->cq = cq;
+  }
+  io->sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(
+    NULL,
+    io->sqesSize,
+    PROT_READ | PROT_WRITE,
+    MAP_SHARED | MAP_POPULATE,
+    io->ring,
+    IORING_OFF_SQES
+  );
+  if (sqes == MAP_FAILED) {
+    quorum_uring_free(io);
+    return UV_ENOMEM;
+  }
+  io->sqes = sqes;
+  io->sqHead = (unsigned*) (io->sq + params.sq_off.head);
+  io->sqTail = (unsigned*) (io->sq + params.sq_off.tail);
+  io->sqArray = (unsigned*) (io->sq + params.sq_off.array);
+  io->sqMask = *(unsigned*) (io->sq + params.sq_off.ring_mask);
+  io->cqHead = (unsigned*) (io->cq + params.cq_off.head);
+  io->cqTail = (unsigned*) (io->cq + params.cq_off.tail);
+  io->cqMask = *(unsigned*) (io->cq + params.cq_off.ring_mask);
+  io->cqes = (struct io_uring_cqe*) (io->cq + params.cq_off.cqes);
+  io->entries = params.sq_entries;
+  io->inflight = 0;
+  io->queued = 0;
+  io->failed = 0;
+  return 0;
+}
+
+static void quorum_uring_done(
+  struct quorum_io* io,
+  struct quorum_io_request* request
+) {
+  request->next = io->done;
+  io->done = request;
+}
+
+static void quorum_uring_fill(struct quorum_io* io) {
+  // Once the ring has failed, requests fail instead of being submitted:
+  if (io->failed) {
+    struct quorum_io_request* request;
+    while ((request = quorum_io_shift(io)) != NULL) {
+      request->error = io->failed;
+      quorum_uring_done(io, request);
+    }
+    return;
+  }
+  // There is a single producer, so the tail is only read by the kernel:
+  unsigned tail = *io->sqTail;
+  while (io->inflight < io->entries && io->head != NULL) {
+    struct quorum_io_request* request = quorum_io_shift(io);
+    const unsigned index = tail & io->sqMask;
+    struct io_uring_sqe* sqe = &io->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    // READV and WRITEV, unlike READ and WRITE, are supported since 5.1:
+    request->iov.iov_base = request->buffer;
+    request->iov.iov_len = (size_t) request->length;
+    sqe->opcode = request->write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = request->fd;
+    sqe->addr = (uint64_t) (uintptr_t) &request->iov;
+    sqe->len = 1;
+    sqe->off = (uint64_t) request->offset;
+    sqe->user_data = (uint64_t) (uintptr_t) request;
+    io->sqArray[index] = index;
+    tail++;
+    io->inflight++;
+    io->queued++;
+  }
+  __atomic_store_n(io->sqTail, tail, __ATOMIC_RELEASE);
+}
+
+// Moves every completed request to done, or queues it again to continue a
+// short read or write. Returns the number of completions reaped:
+static unsigned quorum_uring_reap(struct quorum_io* io) {
+  unsigned head = *io->cqHead;
+  const unsigned tail = __atomic_load_n(io->cqTail, __ATOMIC_ACQUIRE);
+  const unsigned reaped = tail - head;
+  while (head != tail) {
+    const struct io_uring_cqe* cqe = &io->cqes[head & io->cqMask];
+    struct quorum_io_request* request = (struct quorum_io_request*) (
+      (uintptr_t) cqe->user_data
+    );
+    const int result = cqe->res;
+    head++;
+    assert(io->inflight > 0);
+    io->inflight--;
+    if (result < 0) {
+      // Negated errno, as are libuv error codes on Unix:
+      request->error = result;
+    } else if (result == 0) {
+      request->error = request->write ? UV_EIO : UV_EOF;
+    } else if (result < request->length) {
+      // Continue a short read or write (which fails if the ring has failed):
+      request->buffer += result;
+      request->length -= result;
+      request->offset += result;
+      if (io->failed) {
+        request->error = io->failed;
+      } else {
+        quorum_io_push(io, request);
+        continue;
+      }
+    }
+    quorum_uring_done(io, request);
+  }
+  __atomic_store_n(io->cqHead, head, __ATOMIC_RELEASE);
+  return reaped;
+}
+
+// Fails every request after an unexpected error from io_uring_enter(), as the
+// pread() pool fails a request, once the kernel has released its buffers:
+static void quorum_uring_fail(struct quorum_io* io, const int error) {
+  assert(error < 0);
+  io->failed = error;
+  // Without SQPOLL, the kernel reads the tail only when entered, so entries
+  // which were not entered can be taken back:
+  unsigned tail = *io->sqTail;
+  while (io->queued > 0) {
+    tail--;
+    const struct io_uring_sqe* sqe = &io->sqes[tail & io->sqMask];
+    struct quorum_io_request* request = (struct quorum_io_request*) (
+      (uintptr_t) sqe->user_data
+    );
+    request->error = error;
+    quorum_uring_done(io, request);
+    io->queued--;
+    assert(io->inflight > 0);
+    io->inflight--;
+  }
+  __atomic_store_n(io->sqTail, tail, __ATOMIC_RELEASE);
+  quorum_uring_fill(io);
+  // Requests which the kernel has accepted still reference their buffers:
+  while (io->inflight > 0) {
+    const int result = (int) syscall(
+      __NR_io_uring_enter,
+      io->ring,
+      0,
+      io->inflight,
+      IORING_ENTER_GETEVENTS,
+      NULL,
+      0
+    );
+    // If even waiting fails, poll for completions without busy waiting:
+    if (quorum_uring_reap(io) == 0 && result < 0 && errno != EINTR) {
+      uv_sleep(1);
+    }
+  }
+}
+
+static void quorum_uring_wait(struct quorum_io* io) {
+  quorum_uring_fill(io);
+  if (io->failed) return;
+  assert(io->inflight > 0);
+  unsigned submit = io->queued;
+  while (1) {
+    const int result = (int) syscall(
+      __NR_io_uring_enter,
+      io->ring,
+      submit,
+      1,
+      IORING_ENTER_GETEVENTS,
+      NULL,
+      0
+    );
+    if (result >= 0) {
+      assert((unsigned) result <= io->queued);
+      io->queued -= (unsigned) result;
+      break;
+    }
+    const int error = -errno;
+    if (error == UV_EINTR) continue;
+    // The kernel is short of resources, or has completions to post first:
+    // reap those already posted, or else stop submitting and wait for some
+    // to complete, if the kernel has any requests in flight to complete:
+    if (error == UV_EAGAIN || error == UV_EBUSY) {
+      if (quorum_uring_reap(io) > 0) return;
+      if (io->inflight > io->queued) {
+        submit = 0;
+        continue;
+      }
+    }
+    quorum_uring_fail(io, error);
+    return;
+  }
+  quorum_uring_reap(io);
+}
+#endif
+
+static void quorum_io_thread(void* data) {
+  struct quorum_io* io = data;
+  uv_mutex_lock(&io->mutex);
+  while (1) {
+    while (!io->stop && io->head == NULL) uv_cond_wait(&io->work, &io->mutex);
+    struct quorum_io_request* request = quorum_io_shift(io);
+    if (request == NULL) break;
+    uv_mutex_unlock(&io->mutex);
+    request->error = quorum_transfer(
+      request->fd,
+      request->buffer,
+      request->length,
+      request->offset,
+      request->write
+    );
+    uv_mutex_lock(&io->mutex);
+    request->next = io->done;
+    io->done = request;
+    uv_cond_signal(&io->completed);
+  }
+  uv_mutex_unlock(&io->mutex);
+}
+
+static void quorum_io_free(struct quorum_io* io) {
+#if defined(QUORUM_URING)
+  if (io->uring) {
+    assert(io->inflight == 0);
+    quorum_uring_free(io);
+    return;
+  }
+#endif
+  uv_mutex_lock(&io->mutex);
+  io->stop = 1;
+  uv_cond_broadcast(&io->work);
+  uv_mutex_unlock(&io->mutex);
+  for (int64_t index = 0; index < io->threadsLength; index++) {
+    assert(uv_thread_join(&io->threads[index]) == 0);
+  }
+  uv_cond_destroy(&io->completed);
+  uv_cond_destroy(&io->work);
+  uv_mutex_destroy(&io->mutex);
+}
+
+static int quorum_io_init(
+  struct quorum_io* io,
+  const int uring,
+  const int64_t requests
+) {
+  assert(requests >= 1);
+  io->uring = 0;
+  io->head = NULL;
+  io->tail = NULL;
+  io->done = NULL;
+#if defined(QUORUM_URING)
+  if (uring && quorum_uring_init(io, requests) == 0) {
+    io->uring = 1;
+    return 0;
+  }
+#endif
+  io->stop = 0;
+  io->threadsLength = 0;
+  if (uv_mutex_init(&io->mutex) != 0) return UV_ENOMEM;
+  if (uv_cond_init(&io->work) != 0) {
+    uv_mutex_destroy(&io->mutex);
+    return UV_ENOMEM;
+  }
+  if (uv_cond_init(&io->completed) != 0) {
+    uv_cond_destroy(&io->work);
+    uv_mutex_destroy(&io->mutex);
+    return UV_ENOMEM;
+  }
+  const int64_t threads = requests < QUORUM_IO_THREADS ?
+    requests : QUORUM_IO_THREADS;
+  for (int64_t index = 0; index < threads; index++) {
+    int error = uv_thread_create(
+      &io->threads[index],
+      quorum_io_thread,
+      io
+    );
+    if (error) {
+      quorum_io_free(io);
+      return error;
+    }
+    io->threadsLength++;
+  }
+  return 0;
+}
+
+static void quorum_io_submit(
+  struct quorum_io* io,
+  struct quorum_io_slot* slot,
+  struct quorum_io_request* request
+) {
+  assert(request->length > 0);
+  request->slot = slot;
+  request->error = 0;
+  slot->pending++;
+  if (io->uring) {
+    quorum_io_push(io, request);
+    return;
+  }
+  uv_mutex_lock(&io->mutex);
+  quorum_io_push(io, request);
+  uv_cond_signal(&io->work);
+  uv_mutex_unlock(&io->mutex);
+}
+
+// Waits for at least one request to complete, and updates the slots of every
+// request completed:
+static void quorum_io_reap(struct quorum_io* io) {
+  struct quorum_io_request* request;
+#if defined(QUORUM_URING)
+  // A short read or write is queued again rather than completed, so wait
+  // until at least one request has completed:
+  if (io->uring) {
+    while (io->done == NULL) quorum_uring_wait(io);
+  }
+#endif
+  if (!io->uring) {
+    uv_mutex_lock(&io->mutex);
+    while (io->done == NULL) uv_cond_wait(&io->completed, &io->mutex);
+  }
+  request = io->done;
+  io->done = NULL;
+  if (!io->uring) uv_mutex_unlock(&io->mutex);
+  assert(request != NULL);
+  while (request != NULL) {
+    struct quorum_io_request* next = request->next;
+    struct quorum_io_slot* slot = request->slot;
+    assert(slot->pending > 0);
+    slot->pending--;
+    if (request->error && !slot->error) slot->error = request->error;
+    if (request->write) free(request);
+    request = next;
+  }
+}
+
+// Writes back the objects of each replica rewritten by repair, a run of
+// consecutive objects at a time:
+static int quorum_io_rewritten(
+  const struct quorum_context* ctx,
+  struct quorum_io* io,
+  struct quorum_io_slot* slot
+) {
+  const int64_t objectSize = ctx->objectSize;
+  for (int64_t index = 0; index < ctx->sourcesLength; index++) {
+    const uint8_t mask = (uint8_t) (1 << (index & 7));
+    const uint8_t* bitmap = slot->rewritten + (index >> 3);
+    int64_t object = 0;
+    while (object < slot->length) {
+      if ((bitmap[object * QUORUM_BITMAP] & mask) == 0) {
+        object++;
+        continue;
+      }
+      int64_t run = object;
+      while (run < slot->length && (bitmap[run * QUORUM_BITMAP] & mask)) run++;
+      struct quorum_io_request* request = malloc(sizeof(*request));
+      if (request == NULL) return UV_ENOMEM;
+      request->fd = ctx->fds[index];
+      request->write = 1;
+      request->buffer = slot->buffer + index * ctx->window +
+        object * objectSize;
+      request->length = (run - object) * objectSize;
+      request->offset = ctx->extents[0].sourceOffset +
+        (slot->object + object) * objectSize;
+      quorum_io_submit(io, slot, request);
+      object = run;
+    }
+  }
+  return 0;
+}
+
+static int quorum_execute_files(
+  const struct quorum_context* ctx,
+  struct quorum_sparse* sparse
+) {
+  assert(ctx->files);
+  assert(ctx->extentsLength == 1);
+  assert(ctx->window >= ctx->objectSize);
+  assert(ctx->window % ctx->objectSize == 0);
+  assert(ctx->depth >= 1);
+  assert(ctx->depth <= QUORUM_DEPTH_MAX);
+  const int64_t objectSize = ctx->objectSize;
+  const int64_t window = ctx->window;
+  const int64_t sourcesLength = ctx->sourcesLength;
+  const struct quorum_extent* extent = &ctx->extents[0];
+  if (ctx->begin == ctx->end) return 0;
+  const int64_t windowObjects = window / objectSize;
+  const int64_t windows = (ctx->end - ctx->begin + windowObjects - 1) /
+    windowObjects;
+  const int64_t slotsLength = ctx->depth < windows ? ctx->depth : windows;
+  // Memory is bounded by the window and depth, however large the region:
+  uint8_t* buffer = malloc(slotsLength * sourcesLength * window);
+  uint8_t* rewritten = ctx->repaired != NULL ?
+    malloc(slotsLength * windowObjects * QUORUM_BITMAP) : NULL;
+  struct quorum_io_slot* slots = calloc(slotsLength, sizeof(*slots));
+  struct quorum_io_request* reads = calloc(
+    slotsLength * sourcesLength,
+    sizeof(*reads)
+  );
+  struct quorum_context* chunk = quorum_pool_acquire(&quorum_context_pool);
+  if (
+    buffer == NULL ||
+    (ctx->repaired != NULL && rewritten == NULL) ||
+    slots == NULL ||
+    reads == NULL ||
+    chunk == NULL
+  ) {
+    if (chunk != NULL) quorum_pool_release(&quorum_context_pool, chunk);
+    free(reads);
+    free(slots);
+    free(rewritten);
+    free(buffer);
+    return UV_ENOMEM;
+  }
+  struct quorum_io io;
+  int error = quorum_io_init(&io, ctx->uring, slotsLength * sourcesLength);
+  if (error) {
+    quorum_pool_release(&quorum_context_pool, chunk);
+    free(reads);
+    free(slots);
+    free(rewritten);
+    free(buffer);
+    return error;
+  }
+  for (int64_t index = 0; index < slotsLength; index++) {
+    slots[index].buffer = buffer + index * sourcesLength * window;
+    slots[index].rewritten = rewritten != NULL ?
+      rewritten + index * windowObjects * QUORUM_BITMAP : NULL;
+    slots[index].reads = reads + index * sourcesLength;
+  }
+  *chunk = *ctx;
+  chunk->files = 0;
+  chunk->extents = &chunk->extent;
+  chunk->extentsLength = 1;
+  // Windows are calculated in order, each as soon as the reads of every file
+  // have landed, while the reads of the next windows are in flight:
+  int64_t submitted = 0;
+  int64_t calculated = 0;
+  while (calculated < windows) {
+    // Refill a slot once its window has been calculated and any writes of
+    // its repaired objects have landed:
+    while (
+      submitted < windows &&
+      submitted < calculated + slotsLength &&
+      slots[submitted % slotsLength].pending == 0
+    ) {
+      struct quorum_io_slot* slot = &slots[submitted % slotsLength];
+      if (slot->error) break;
+      slot->object = ctx->begin + submitted * windowObjects;
+      slot->length = ctx->end - slot->object < windowObjects ?
+        ctx->end - slot->object : windowObjects;
+      for (int64_t index = 0; index < sourcesLength; index++) {
+        struct quorum_io_request* request = &slot->reads[index];
+        request->fd = ctx->fds[index];
+        request->write = 0;
+        request->buffer = slot->buffer + index * window;
+        request->length = slot->length * objectSize;
+        request->offset = extent->sourceOffset + slot->object * objectSize;
+        quorum_io_submit(&io, slot, request);
+      }
+      submitted++;
+    }
+    struct quorum_io_slot* slot = &slots[calculated % slotsLength];
+    if (slot->error) {
+      error = slot->error;
+      break;
+    }
+    if (calculated == submitted || slot->pending > 0) {
+      quorum_io_reap(&io);
+      continue;
+    }
+    const int64_t object = slot->object;
+    for (int64_t index = 0; index < sourcesLength; index++) {
+      chunk->sources[index] = slot->buffer + index * window;
+    }
+    chunk->extent.begin = 0;
+    chunk->extent.end = slot->length;
+    chunk->extent.sourceOffset = 0;
+    chunk->extent.quorum = extent->quorum != NULL ?
+      extent->quorum + object * QUORUM_SIZE : NULL;
+    chunk->extent.target = extent->target != NULL ?
+      extent->target + object * objectSize : NULL;
+    chunk->objects = slot->length;
+    chunk->begin = 0;
+    chunk->end = slot->length;
+    chunk->leaders = ctx->leaders != NULL ? ctx->leaders + object : NULL;
+    chunk->members = ctx->members != NULL ?
+      ctx->members + object * QUORUM_BITMAP : NULL;
+    chunk->lagging = ctx->lagging != NULL ?
+      ctx->lagging + object * QUORUM_BITMAP : NULL;
+    chunk->repaired = ctx->repaired != NULL ? ctx->repaired + object : NULL;
+    chunk->rewritten = slot->rewritten;
+    if (slot->rewritten != NULL) {
+      memset(slot->rewritten, 0, slot->length * QUORUM_BITMAP);
+    }
+    chunk->cache = ctx->cache != NULL ?
+      ctx->cache + object * QUORUM_CACHE : NULL;
+    chunk->changed = ctx->changed != NULL ? ctx->changed + object : NULL;
+    chunk->rejected = ctx->rejected != NULL ? ctx->rejected + object : NULL;
+    chunk->sparseBase = ctx->sparseBase + object;
+    error = quorum_execute_sources(chunk, sparse);
+    if (error) break;
+    if (slot->rewritten != NULL) {
+      error = quorum_io_rewritten(ctx, &io, slot);
+      if (error) break;
+    }
+    calculated++;
+  }
+  // Requests in flight reference the buffers, and must land before these are
+  // freed, even after an error:
+  for (int64_t index = 0; index < slotsLength; index++) {
+    while (slots[index].pending > 0) quorum_io_reap(&io);
+    // A write fails after its window was calculated:
+    if (!error && slots[index].error) error = slots[index].error;
+  }
+  quorum_io_free(&io);
+  quorum_pool_release(&quorum_context_pool, chunk);
+  free(reads);
+  free(slots);
+  free(rewritten);
+  free(buffer);
+  assert(error != QUORUM_ERROR_UNDEFINED);
+  assert(error != QUORUM_ERROR_COMPLETED);
+  return error;
+}
+
+// Returns the segment of a list containing the byte at offset, advancing the
+// cursor, which only moves forward since objects are visited in order:
+static const struct quorum_segment* quorum_segment_find(
+  const struct quorum_context* ctx,
+  int64_t list,
+  int64_t* cursor,
+  int64_t offset
+) {
+  while (
+    ctx->segments[*cursor].offset + ctx->segments[*cursor].length <= offset
+  ) {
+    (*cursor)++;
+    assert(*cursor < ctx->segmentsIndex[list + 1]);
+  }
+  assert(ctx->segments[*cursor].offset <= offset);
+  return &ctx->segments[*cursor];
+}
+
+// Copies an object that straddles segments to (gather) or from a buffer:
+static void quorum_segment_copy(
+  const struct quorum_context* ctx,
+  int64_t list,
+  int64_t cursor,
+  int64_t offset,
+  uint8_t* buffer,
+  const int gather
+) {
+  int64_t length = ctx->objectSize;
+  while (length > 0) {
+    const struct quorum_segment* segment = quorum_segment_find(
+      ctx,
+      list,
+      &cursor,
+      offset
+    );
+    int64_t size = segment->offset + segment->length - offset;
+    if (size > length) size = length;
+    uint8_t* pointer = segment->base + (offset - segment->offset);
+    if (gather) {
+      memcpy(buffer, pointer, size);
+    } else {
+      memcpy(pointer, buffer, size);
+    }
+    buffer += size;
+    offset += size;
+    length -= size;
+  }
+}
+
+static int quorum_execute_segments(
+  const struct quorum_context* ctx,
+  struct quorum_sparse* sparse
+) {
+  assert(ctx->segmented);
+  assert(ctx->segments != NULL);
+  const int64_t objectSize = ctx->objectSize;
+  const int64_t sourcesLength = ctx->sourcesLength;
+  // The target is the last list, and may be empty:
+  const int64_t lists = sourcesLength + 1;
+  const int64_t targetList = sourcesLength;
+  const int hasTarget = ctx->segmentsIndex[targetList] <
+    ctx->segmentsIndex[lists];
+  struct quorum_context* chunk = quorum_pool_acquire(&quorum_context_pool);
+  if (chunk == NULL) return UV_ENOMEM;
+  *chunk = *ctx;
+  chunk->segmented = 0;
+  chunk->extents = &chunk->extent;
+  chunk->extentsLength = 1;
+  // Objects that straddle segments are copied, one at a time:
+  uint8_t* bounce = NULL;
+  int64_t cursors[256];
+  uint8_t* pointers[256];
+  int straddled[256];
+  int error = 0;
+  for (int64_t index = 0; index < ctx->extentsLength && !error; index++) {
+    const struct quorum_extent* extent = &ctx->extents[index];
+    int64_t object = extent->begin > ctx->begin ? extent->begin : ctx->begin;
+    const int64_t end = extent->end < ctx->end ? extent->end : ctx->end;
+    for (int64_t list = 0; list < lists; list++) {
+      cursors[list] = ctx->segmentsIndex[list];
+    }
+    while (object < end) {
+      // Find the longest run of whole objects within a segment of each list:
+      int64_t length = end - object;
+      int straddles = 0;
+      for (int64_t list = 0; list < lists; list++) {
+        if (list == targetList && !hasTarget) break;
+        const int64_t offset = (object - extent->begin) * objectSize + (
+          list == targetList ? extent->targetOffset : extent->sourceOffset
+        );
+        const struct quorum_segment* segment = quorum_segment_find(
+          ctx,
+          list,
+          &cursors[list],
+          offset
+        );
+        const int64_t whole =
+          (segment->offset + segment->length - offset) / objectSize;
+        pointers[list] = segment->base + (offset - segment->offset);
+        straddled[list] = whole == 0;
+        if (whole == 0) {
+          straddles = 1;
+        } else if (whole < length) {
+          length = whole;
+        }
+      }
+      if (straddles) {
+        length = 1;
+        if (bounce == NULL) {
+          bounce = malloc(lists * objectSize);
+          if (bounce == NULL) {
+            error = UV_ENOMEM;
+            break;
+          }
+        }
+        for (int64_t list = 0; list < lists; list++) {
+          if (list == targetList && !hasTarget) break;
+          if (!straddled[list]) continue;
+          pointers[list] = bounce + list * objectSize;
+          if (list == targetList) continue;
+          quorum_segment_copy(
+            ctx,
+            list,
+            cursors[list],
+            (object - extent->begin) * objectSize + extent->sourceOffset,
+            pointers[list],
+            1
+          );
+        }
+      }
+      for (int64_t list = 0; list < sourcesLength; list++) {
+        chunk->sources[list] = pointers[list];
+      }
+      chunk->extent.begin = 0;
+      chunk->extent.end = length;
+      chunk->extent.sourceOffset = 0;
+      chunk->extent.quorum = extent->quorum != NULL ?
+        extent->quorum + (object - extent->begin) * QUORUM_SIZE : NULL;
+      chunk->extent.target = hasTarget ? pointers[targetList] : NULL;
+      chunk->objects = length;
+      chunk->begin = 0;
+      chunk->end = length;
+      chunk->leaders = ctx->leaders != NULL ? ctx->leaders + object : NULL;
+      chunk->members = ctx->members != NULL ?
+        ctx->members + object * QUORUM_BITMAP : NULL;
+      chunk->lagging = ctx->lagging != NULL ?
+        ctx->lagging + object * QUORUM_BITMAP : NULL;
+      chunk->repaired = ctx->repaired != NULL ? ctx->repaired + object : NULL;
+      chunk->cache = ctx->cache != NULL ?
+        ctx->cache + object * QUORUM_CACHE : NULL;
+      chunk->changed = ctx->changed != NULL ? ctx->changed + object : NULL;
+      chunk->rejected = ctx->rejected != NULL ? ctx->rejected + object : NULL;
+      chunk->sparseBase = ctx->sparseBase + object;
+      error = quorum_execute_sources(chunk, sparse);
+      if (error) break;
+      if (straddles) {
+        // Scatter the target, and any sources rewritten by repair:
+        for (int64_t list = 0; list < lists; list++) {
+          if (list == targetList && !hasTarget) break;
+          if (!straddled[list]) continue;
+          if (list < sourcesLength) {
+            if (ctx->repaired == NULL || ctx->repaired[object] == 0) continue;
+          }
+          quorum_segment_copy(
+            ctx,
+            list,
+            cursors[list],
+            (object - extent->begin) * objectSize + (
+              list == targetList ? extent->targetOffset : extent->sourceOffset
+            ),
+            pointers[list],
+            0
+          );
+        }
+      }
+      object += length;
+    }
+  }
+  quorum_pool_release(&quorum_context_pool, chunk);
+  if (bounce != NULL) free(bounce);
+  assert(error != QUORUM_ERROR_UNDEFINED);
+  assert(error != QUORUM_ERROR_COMPLETED);
+  return error;
+}
+
+static int quorum_execute(
+  const struct quorum_context* ctx,
+  struct quorum_sparse* sparse
+) {
+  if (ctx->files) return quorum_execute_files(ctx, sparse);
+  if (ctx->segmented) return quorum_execute_segments(ctx, sparse);
+  return quorum_execute_sources(ctx, sparse);
+}
+
+napi_value quorum_error(napi_env env, int error) {
+  assert(error != 0);
+  napi_value code;
+  napi_value message;
+  napi_value result;
+  // Reading files, or creating threads, may fail with a libuv error code:
+  if (error < 0) {
+    assert(
+      napi_create_string_utf8(
+        env,
+        uv_err_name(error),
+        NAPI_AUTO_LENGTH,
+        &code
+      ) == napi_ok
+    );
+    assert(
+      napi_create_string_utf8(
+        env,
+        uv_strerror(error),
+        NAPI_AUTO_LENGTH,
+        &message
+      ) == napi_ok
+    );
+    napi_create_error(env, code, message, &result);
+    return result;
+  }
+  if (error == QUORUM_ERROR_ABORTED) {
+    assert(
+      napi_create_string_utf8(env, "ABORT_ERR", NAPI_AUTO_LENGTH, &code) ==
+      napi_ok
+    );
+    assert(
+      napi_create_string_utf8(
+        env,
+        "The operation was aborted",
+        NAPI_AUTO_LENGTH,
+        &message
+      ) == napi_ok
+    );
+    napi_create_error(env, code, message, &result);
+    return result;
+  }
+  assert(error == QUORUM_ERROR_CYCLIC);
+  assert(
+    napi_create_string_utf8(
+      env,
+      "ERR_CYCLIC_REFERENCES",
+      NAPI_AUTO_LENGTH,
+      &code
+    ) == napi_ok
+  );
+  assert(
+    napi_create_string_utf8(
+      env,
+      "vectors must not have cyclic references",
+      NAPI_AUTO_LENGTH,
+      &message
+    ) == napi_ok
+  );
+  napi_create_error(env, code, message, &result);
+  return result;
+}
+
+static inline uint64_t quorum_read_uint64(const uint8_t* buffer) {
+  uint64_t value = 0;
+  for (int index = 7; index >= 0; index--) value = (value << 8) | buffer[index];
+  return value;
+}
+
+static inline void quorum_write_uint64(uint8_t* buffer, uint64_t value) {
+  for (int index = 0; index < 8; index++) {
+    buffer[index] = (uint8_t) value;
+    value >>= 8;
+  }
+}
+
+static void quorum_descriptor(
+  uint8_t* descriptor,
+  const int64_t sourceOffset,
+  const int64_t sourceSize,
+  const int64_t quorumOffset,
+  const int64_t targetOffset
+) {
+  quorum_write_uint64(descriptor + 0, (uint64_t) sourceOffset);
+  quorum_write_uint64(descriptor + 8, (uint64_t) sourceSize);
+  quorum_write_uint64(descriptor + 16, (uint64_t) quorumOffset);
+  quorum_write_uint64(descriptor + 24, (uint64_t) targetOffset);
+}
+
+static int quorum_extents(struct quorum_context* ctx) {
+  // Descriptors are validated, and are copied so that they cannot change:
+  assert(ctx->descriptors != NULL);
+  assert(ctx->extentsLength >= 1);
+  ctx->extents = &ctx->extent;
+  if (ctx->extentsLength > 1) {
+    ctx->extents = malloc(ctx->extentsLength * sizeof(struct quorum_extent));
+    if (ctx->extents == NULL) return 0;
+  }
+  int64_t begin = 0;
+  for (int64_t index = 0; index < ctx->extentsLength; index++) {
+    const uint8_t* descriptor = ctx->descriptors + index * QUORUM_EXTENT;
+    const int64_t sourceOffset = (int64_t) quorum_read_uint64(descriptor + 0);
+    const int64_t sourceSize = (int64_t) quorum_read_uint64(descriptor + 8);
+    const int64_t quorumOffset = (int64_t) quorum_read_uint64(descriptor + 16);
+    const int64_t targetOffset = (int64_t) quorum_read_uint64(descriptor + 24);
+    assert(sourceSize > 0);
+    assert(sourceSize % ctx->objectSize == 0);
+    struct quorum_extent* extent = &ctx->extents[index];
+    extent->begin = begin;
+    extent->end = begin + sourceSize / ctx->objectSize;
+    extent->sourceOffset = sourceOffset;
+    extent->targetOffset = targetOffset;
+    extent->quorum = ctx->quorum != NULL ? ctx->quorum + quorumOffset : NULL;
+    extent->target = ctx->target != NULL ? ctx->target + targetOffset : NULL;
+    begin = extent->end;
+  }
+  assert(begin == ctx->objects);
+  ctx->descriptors = NULL;
+  return 1;
+}
+
+static void quorum_extents_free(struct quorum_context* ctx) {
+  if (ctx->extents != NULL && ctx->extents != &ctx->extent) {
+    free(ctx->extents);
+  }
+  ctx->extents = NULL;
+  if (ctx->segments != NULL) free(ctx->segments);
+  ctx->segments = NULL;
+  if (ctx->wideSources != NULL) free(ctx->wideSources);
+  ctx->wideSources = NULL;
+}
+
+// Reads the sources of calculateWide() once all arguments have been
+// validated, and checks that none was changed since (by an options getter):
+static int quorum_wide_sources(
+  napi_env env,
+  struct quorum_context* ctx,
+  napi_value sourcesValue
+) {
+  assert(ctx->wide);
+  assert(ctx->wideSources == NULL);
+  assert(ctx->extentsLength == 1);
+  ctx->wideSources = malloc(ctx->sourcesLength * sizeof(uint8_t*));
+  if (ctx->wideSources == NULL) return 0;
+  const struct quorum_extent* extent = &ctx->extents[0];
+  const int64_t size = extent->sourceOffset + ctx->objects * ctx->objectSize;
+  for (int64_t index = 0; index < ctx->sourcesLength; index++) {
+    napi_value element;
+    bool isBuffer;
+    void* data;
+    size_t length;
+    if (
+      napi_get_element(env, sourcesValue, index, &element) != napi_ok ||
+      napi_is_buffer(env, element, &isBuffer) != napi_ok ||
+      !isBuffer ||
+      napi_get_buffer_info(env, element, &data, &length) != napi_ok ||
+      (int64_t) length < size
+    ) {
+      return 0;
+    }
+    ctx->wideSources[index] = data;
+  }
+  return 1;
+}
+
+// Appends the segments of a buffer or an array of buffers to the table:
+static napi_status quorum_segments_append(
+  napi_env env,
+  napi_value value,
+  struct quorum_segment* segments,
+  int64_t capacity,
+  int64_t* length
+) {
+  napi_status status;
+  bool isBuffer;
+  status = napi_is_buffer(env, value, &isBuffer);
+  if (status != napi_ok) return status;
+  uint32_t count = 1;
+  if (!isBuffer) {
+    status = napi_get_array_length(env, value, &count);
+    if (status != napi_ok) return status;
+  }
+  int64_t offset = 0;
+  for (uint32_t index = 0; index < count; index++) {
+    napi_value segment = value;
+    if (!isBuffer) {
+      status = napi_get_element(env, value, index, &segment);
+      if (status != napi_ok) return status;
+    }
+    void* data;
+    size_t size;
+    status = napi_get_buffer_info(env, segment, &data, &size);
+    if (status != napi_ok) return status;
+    if (segments != NULL) {
+      assert(*length < capacity);
+      segments[*length].base = data;
+      segments[*length].offset = offset;
+      segments[*length].length = (int64_t) size;
+    }
+    offset += (int64_t) size;
+    (*length)++;
+  }
+  return napi_ok;
+}
+
+// Builds the segment table once all arguments have been validated, and checks
+// that no array of segments was changed since (by an options getter):
+static int quorum_segments(
+  napi_env env,
+  struct quorum_context* ctx,
+  napi_value sourcesValue,
+  napi_value targetValue
+) {
+  assert(ctx->segmented);
+  assert(ctx->segments == NULL);
+  assert(ctx->extents != NULL);
+  int64_t capacity = 0;
+  for (int pass = 0; pass < 2; pass++) {
+    if (pass == 1) {
+      ctx->segments = malloc(capacity * sizeof(struct quorum_segment));
+      if (ctx->segments == NULL) return 0;
+    }
+    int64_t length = 0;
+    for (int64_t index = 0; index < ctx->sourcesLength; index++) {
+      ctx->segmentsIndex[index] = length;
+      napi_value element;
+      if (napi_get_element(env, sourcesValue, index, &element) != napi_ok) {
+        return 0;
+      }
+      if (
+        quorum_segments_append(
+          env,
+          element,
+          ctx->segments,
+          capacity,
+          &length
+        ) != napi_ok
+      ) {
+        return 0;
+      }
+    }
+    ctx->segmentsIndex[ctx->sourcesLength] = length;
+    if (ctx->target != NULL || ctx->targetSegmented) {
+      assert(targetValue != NULL);
+      if (
+        quorum_segments_append(
+          env,
+          targetValue,
+          ctx->segments,
+          capacity,
+          &length
+        ) != napi_ok
+      ) {
+        return 0;
+      }
+    }
+    ctx->segmentsIndex[ctx->sourcesLength + 1] = length;
+    if (pass == 1) assert(length == capacity);
+    capacity = length;
+  }
+  // Every extent must still fall within each list:
+  for (int64_t list = 0; list <= ctx->sourcesLength; list++) {
+    const int64_t first = ctx->segmentsIndex[list];
+    const int64_t last = ctx->segmentsIndex[list + 1];
+    if (first == last) continue;
+    const int64_t total = ctx->segments[last - 1].offset +
+      ctx->segments[last - 1].length;
+    for (int64_t index = 0; index < ctx->extentsLength; index++) {
+      const struct quorum_extent* extent = &ctx->extents[index];
+      const int64_t offset = list == ctx->sourcesLength ?
+        extent->targetOffset : extent->sourceOffset;
+      if (offset + (extent->end - extent->begin) * ctx->objectSize > total) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+void quorum_async_execute(napi_env env, void* data) {
+  struct quorum_context* ctx = data;
+  assert(ctx->error != QUORUM_ERROR_COMPLETED);
+  assert(ctx->error == QUORUM_ERROR_UNDEFINED);
+  // Sparse entries continue from the previous chunk:
+  ctx->error = quorum_execute(
+    ctx,
+    ctx->sparse.entries != NULL ? &ctx->sparse : NULL
+  );
+  assert(ctx->error <= 1);
+}
+
+void quorum_async_complete(napi_env env, napi_status status, void* data);
+
+static void quorum_async_queue(napi_env env, struct quorum_context* ctx) {
+  napi_value resource_name;
   assert(
     napi_create_string_utf8(
       env,
-      "ERR_CYCLIC_REFERENCES",
-      NAPI_AUTO_LENGTH,
-      &code
-    ) == napi_ok
+      "@ronomon/quorum",
+      NAPI_AUTO_LENGTH,
+      &resource_name
+    ) == napi_ok
+  );
+  assert(
+    napi_create_async_work(
+      env,
+      NULL,
+      resource_name,
+      quorum_async_execute,
+      quorum_async_complete,
+      ctx,
+      &ctx->async_work
+    ) == napi_ok
+  );
+  assert(napi_queue_async_work(env, ctx->async_work) == napi_ok);
+}
+
+// Calls options.progress after each chunk, and then reads options.signal
+// before queueing the next chunk. Returns a JS exception thrown by either:
+static napi_value quorum_async_chunk(
+  napi_env env,
+  struct quorum_context* ctx,
+  int* queued
+) {
+  *queued = 0;
+  napi_value exception = NULL;
+  if (ctx->ref_progress != NULL && ctx->end > ctx->begin) {
+    napi_value scope;
+    napi_value progress;
+    napi_value argv[2];
+    napi_value result;
+    assert(napi_get_global(env, &scope) == napi_ok);
+    assert(
+      napi_get_reference_value(env, ctx->ref_progress, &progress) == napi_ok
+    );
+    assert(napi_create_int64(env, ctx->end, &argv[0]) == napi_ok);
+    assert(napi_create_int64(env, ctx->objects, &argv[1]) == napi_ok);
+    if (napi_call_function(env, scope, progress, 2, argv, &result) != napi_ok) {
+      assert(napi_get_and_clear_last_exception(env, &exception) == napi_ok);
+      return exception;
+    }
+  }
+  if (ctx->end == ctx->objects) return NULL;
+  bool aborted = false;
+  if (ctx->ref_signal != NULL) {
+    napi_value signal;
+    napi_value value;
+    assert(napi_get_reference_value(env, ctx->ref_signal, &signal) == napi_ok);
+    if (
+      napi_get_named_property(env, signal, "aborted", &value) != napi_ok ||
+      napi_coerce_to_bool(env, value, &value) != napi_ok
+    ) {
+      assert(napi_get_and_clear_last_exception(env, &exception) == napi_ok);
+      return exception;
+    }
+    assert(napi_get_value_bool(env, value, &aborted) == napi_ok);
+  }
+  if (aborted) {
+    ctx->error = QUORUM_ERROR_ABORTED;
+    return NULL;
+  }
+  // Objects already calculated remain valid whatever happens to the rest:
+  assert(napi_delete_async_work(env, ctx->async_work) == napi_ok);
+  ctx->begin = ctx->end;
+  ctx->end = ctx->objects - ctx->begin > ctx->chunk ?
+    ctx->begin + ctx->chunk : ctx->objects;
+  ctx->error = QUORUM_ERROR_UNDEFINED;
+  quorum_async_queue(env, ctx);
+  *queued = 1;
+  return NULL;
+}
+
+void quorum_async_complete(napi_env env, napi_status status, void* data) {
+  struct quorum_context* ctx = data;
+  assert(ctx->error != QUORUM_ERROR_COMPLETED);
+  assert(ctx->error != QUORUM_ERROR_UNDEFINED);
+  assert(ctx->error <= 1);
+  napi_value exception = NULL;
+  if (ctx->error == 0) {
+    int queued;
+    exception = quorum_async_chunk(env, ctx, &queued);
+    if (queued) return;
+  }
+  napi_value scope;
+  assert(napi_get_global(env, &scope) == napi_ok);
+  napi_value callback;
+  assert(
+    napi_get_reference_value(env, ctx->ref_callback, &callback) == napi_ok
+  );
+  int argc = 0;
+  napi_value argv[2];
+  if (exception != NULL) {
+    argv[argc++] = exception;
+  } else if (ctx->error) {
+    argv[argc++] = quorum_error(env, ctx->error);
+  } else if (ctx->ref_repaired != NULL) {
+    assert(napi_get_null(env, &argv[argc++]) == napi_ok);
+    assert(
+      napi_get_reference_value(env, ctx->ref_repaired, &argv[argc++]) ==
+      napi_ok
+    );
+  } else if (ctx->ref_sparse != NULL) {
+    assert(napi_get_null(env, &argv[argc++]) == napi_ok);
+    assert(
+      napi_create_int64(env, ctx->sparse.length, &argv[argc++]) == napi_ok
+    );
+  }
+  ctx->error = QUORUM_ERROR_COMPLETED;
+  // Do not assert the return status of napi_call_function():
+  // If the user throws our error, then the return status will not be napi_ok.
+  napi_value result;
+  napi_call_function(env, scope, callback, argc, argv, &result);
+  assert(napi_delete_reference(env, ctx->ref_sources) == napi_ok);
+  if (ctx->ref_quorum != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_quorum) == napi_ok);
+  }
+  if (ctx->ref_target != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_target) == napi_ok);
+  }
+  if (ctx->ref_leaders != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_leaders) == napi_ok);
+  }
+  if (ctx->ref_members != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_members) == napi_ok);
+  }
+  if (ctx->ref_lagging != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_lagging) == napi_ok);
+  }
+  if (ctx->ref_cache != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_cache) == napi_ok);
+  }
+  if (ctx->ref_changed != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_changed) == napi_ok);
+  }
+  if (ctx->ref_stats != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_stats) == napi_ok);
+  }
+  if (ctx->ref_sparse != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_sparse) == napi_ok);
+  }
+  if (ctx->ref_rejected != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_rejected) == napi_ok);
+  }
+  if (ctx->ref_progress != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_progress) == napi_ok);
+  }
+  if (ctx->ref_signal != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_signal) == napi_ok);
+  }
+  if (ctx->ref_repaired != NULL) {
+    assert(napi_delete_reference(env, ctx->ref_repaired) == napi_ok);
+  }
+  assert(napi_delete_reference(env, ctx->ref_callback) == napi_ok);
+  assert(napi_delete_async_work(env, ctx->async_work) == napi_ok);
+  quorum_extents_free(ctx);
+  quorum_pool_release(&quorum_context_pool, ctx);
+  ctx = NULL;
+}
+
+static napi_status quorum_option(
+  napi_env env,
+  napi_value options,
+  const char* key,
+  napi_value* value
+) {
+  // Sets value to NULL if there are no options or if the option is undefined:
+  *value = NULL;
+  if (options == NULL) return napi_ok;
+  napi_value property;
+  napi_status status = napi_get_named_property(env, options, key, &property);
+  if (status != napi_ok) return status;
+  napi_valuetype type;
+  status = napi_typeof(env, property, &type);
+  if (status != napi_ok) return status;
+  if (type != napi_undefined) *value = property;
+  return napi_ok;
+}
+
+// Parses an optional Uint8Array output option (and its offset) of at least
+// size bytes after the offset, for example options.leaders (and
+// options.leadersOffset). Sets data to NULL if the option is undefined:
+#define QUORUM_OPTION_ARRAY(env, options, key, size, size_string, value, data) \
+  do {                                                                         \
+    QUORUM_TRY((env), quorum_option((env), (options), key, &(value)));         \
+    (data) = NULL;                                                             \
+    if ((value) != NULL) {                                                     \
+      bool isArray;                                                            \
+      QUORUM_TRY((env), napi_is_typedarray((env), (value), &isArray));         \
+      if (!isArray) {                                                          \
+        QUORUM_THROW((env), "options." key " must be a Uint8Array");           \
+      }                                                                        \
+      napi_typedarray_type arrayType;                                          \
+      size_t arrayLength;                                                      \
+      QUORUM_TRY(                                                              \
+        (env),                                                                 \
+        napi_get_typedarray_info(                                              \
+          (env),                                                               \
+          (value),                                                             \
+          &arrayType,                                                          \
+          &arrayLength,                                                        \
+          (void**) &(data),                                                    \
+          NULL,                                                                \
+          NULL                                                                 \
+        )                                                                      \
+      );                                                                       \
+      if (arrayType != napi_uint8_array) {                                     \
+        QUORUM_THROW((env), "options." key " must be a Uint8Array");           \
+      }                                                                        \
+      napi_value arrayOffsetValue;                                             \
+      QUORUM_TRY(                                                              \
+        (env),                                                                 \
+        quorum_option((env), (options), key "Offset", &arrayOffsetValue)       \
+      );                                                                       \
+      int64_t arrayOffset = 0;                                                 \
+      if (arrayOffsetValue != NULL) {                                          \
+        QUORUM_TRY(                                                            \
+          (env),                                                               \
+          napi_get_value_int64((env), arrayOffsetValue, &arrayOffset)          \
+        );                                                                     \
+        QUORUM_GE((env), arrayOffset, 0, "options." key "Offset", "0");        \
+      }                                                                        \
+      QUORUM_GE(                                                               \
+        (env),                                                                 \
+        (int64_t) arrayLength,                                                 \
+        arrayOffset + (size),                                                  \
+        "options." key ".length",                                              \
+        "options." key "Offset + " size_string                                 \
+      );                                                                       \
+      (data) += arrayOffset;                                                   \
+    }                                                                          \
+  } while (0)
+
+#define QUORUM_MODE_CALCULATE 0
+#define QUORUM_MODE_REPAIR 1
+#define QUORUM_MODE_FILES 2
+#define QUORUM_MODE_WIDE 3
+#define QUORUM_MODE_REPAIR_FILES 4
+
+struct quorum_replicas {
+  uint8_t* sources[255];
+  int64_t sourcesLength;
+  size_t sourceLength;
+  int segmented; // At least one source is an array of segments.
+  napi_ref ref_sources;
+};
+
+// Returns the total length of a buffer or of an array of buffer segments, or
+// -1 if value is neither (without an exception pending):
+static napi_status quorum_segments_length(
+  napi_env env,
+  napi_value value,
+  uint8_t** data,
+  int64_t* length,
+  int* segmented
+) {
+  napi_status status;
+  bool isBuffer;
+  *data = NULL;
+  *length = -1;
+  *segmented = 0;
+  status = napi_is_buffer(env, value, &isBuffer);
+  if (status != napi_ok) return status;
+  if (isBuffer) {
+    size_t size;
+    status = napi_get_buffer_info(env, value, (void**) data, &size);
+    if (status != napi_ok) return status;
+    *length = (int64_t) size;
+    return napi_ok;
+  }
+  bool isArray;
+  status = napi_is_array(env, value, &isArray);
+  if (status != napi_ok || !isArray) return status;
+  uint32_t segments;
+  status = napi_get_array_length(env, value, &segments);
+  if (status != napi_ok) return status;
+  *segmented = 1;
+  int64_t total = 0;
+  for (uint32_t index = 0; index < segments; index++) {
+    napi_value segment;
+    status = napi_get_element(env, value, index, &segment);
+    if (status != napi_ok) return status;
+    status = napi_is_buffer(env, segment, &isBuffer);
+    if (status != napi_ok || !isBuffer) return status;
+    void* segmentData;
+    size_t segmentSize;
+    status = napi_get_buffer_info(env, segment, &segmentData, &segmentSize);
+    if (status != napi_ok) return status;
+    total += (int64_t) segmentSize;
+  }
+  *length = total;
+  return napi_ok;
+}
+
+// Returns sources (or NULL if an exception is pending):
+// Validates each source, storing its buffer in list (unless list is NULL):
+static napi_value quorum_sources_buffers(
+  napi_env env,
+  napi_value sources,
+  const int64_t sourcesLength,
+  uint8_t** list,
+  struct quorum_replicas* replicas
+) {
+  replicas->segmented = 0;
+  for (int64_t index = 0; index < sourcesLength; index++) {
+    napi_value element;
+    QUORUM_TRY(env, napi_get_element(env, sources, index, &element));
+    // Each source is a buffer, or an array of buffer segments:
+    uint8_t* source;
+    int64_t segmentsLength;
+    int segmented;
+    QUORUM_TRY(
+      env,
+      quorum_segments_length(
+        env,
+        element,
+        &source,
+        &segmentsLength,
+        &segmented
+      )
+    );
+    if (segmentsLength < 0) {
+      QUORUM_THROW(env, "sources must be an array of buffers");
+    }
+    if (segmented) replicas->segmented = 1;
+    size_t sourceLength = (size_t) segmentsLength;
+    if (index == 0) {
+      replicas->sourceLength = sourceLength;
+    } else if (sourceLength != replicas->sourceLength) {
+      QUORUM_THROW(env, "sources must have the same length");
+    }
+    if (list != NULL) list[index] = source;
+  }
+  replicas->sourcesLength = sourcesLength;
+  replicas->ref_sources = NULL;
+  return sources;
+}
+
+static napi_value quorum_sources(
+  napi_env env,
+  napi_value sources,
+  struct quorum_replicas* replicas
+) {
+  bool sourcesIsArray;
+  QUORUM_TRY(env, napi_is_array(env, sources, &sourcesIsArray));
+  if (!sourcesIsArray) QUORUM_THROW(env, "sources must be an array");
+  uint32_t sourcesLengthU32;
+  QUORUM_TRY(env, napi_get_array_length(env, sources, &sourcesLengthU32));
+  int64_t sourcesLength = (int64_t) sourcesLengthU32;
+  QUORUM_GE(
+    env,
+    sourcesLength,
+    QUORUM_SOURCES_MIN,
+    "sources.length",
+    "SOURCES_MIN"
+  );
+  QUORUM_LE(
+    env,
+    sourcesLength,
+    QUORUM_SOURCES_MAX,
+    "sources.length",
+    "SOURCES_MAX"
+  );
+  QUORUM_LE(env, sourcesLength, UINT8_MAX, "sources.length", "UINT8_MAX");
+  QUORUM_LE(env, sourcesLength, 255, "sources.length", "255");
+  return quorum_sources_buffers(
+    env,
+    sources,
+    sourcesLength,
+    replicas->sources,
+    replicas
+  );
+}
+
+// Validates the sources of calculateWide(), which are too many to keep in
+// replicas->sources, and are read again by quorum_wide_sources():
+static napi_value quorum_sources_wide(
+  napi_env env,
+  napi_value sources,
+  struct quorum_replicas* replicas
+) {
+  bool sourcesIsArray;
+  QUORUM_TRY(env, napi_is_array(env, sources, &sourcesIsArray));
+  if (!sourcesIsArray) QUORUM_THROW(env, "sources must be an array");
+  uint32_t sourcesLengthU32;
+  QUORUM_TRY(env, napi_get_array_length(env, sources, &sourcesLengthU32));
+  int64_t sourcesLength = (int64_t) sourcesLengthU32;
+  QUORUM_GE(
+    env,
+    sourcesLength,
+    QUORUM_SOURCES_MIN,
+    "sources.length",
+    "SOURCES_MIN"
+  );
+  QUORUM_LE(
+    env,
+    sourcesLength,
+    QUORUM_SOURCES_WIDE_MAX,
+    "sources.length",
+    "SOURCES_WIDE_MAX"
+  );
+  if (
+    quorum_sources_buffers(env, sources, sourcesLength, NULL, replicas) ==
+    NULL
+  ) {
+    return NULL;
+  }
+  if (replicas->segmented) {
+    QUORUM_THROW(env, "sources must be an array of buffers");
+  }
+  return sources;
+}
+
+// Returns fds (or NULL if an exception is pending):
+static napi_value quorum_fds(
+  napi_env env,
+  napi_value fds,
+  uv_file* files,
+  struct quorum_replicas* replicas
+) {
+  bool fdsIsArray;
+  QUORUM_TRY(env, napi_is_array(env, fds, &fdsIsArray));
+  if (!fdsIsArray) QUORUM_THROW(env, "fds must be an array");
+  uint32_t fdsLengthU32;
+  QUORUM_TRY(env, napi_get_array_length(env, fds, &fdsLengthU32));
+  int64_t fdsLength = (int64_t) fdsLengthU32;
+  QUORUM_GE(env, fdsLength, QUORUM_SOURCES_MIN, "fds.length", "SOURCES_MIN");
+  QUORUM_LE(env, fdsLength, QUORUM_SOURCES_MAX, "fds.length", "SOURCES_MAX");
+  for (int64_t index = 0; index < fdsLength; index++) {
+    napi_value element;
+    QUORUM_TRY(env, napi_get_element(env, fds, index, &element));
+    napi_valuetype type;
+    QUORUM_TRY(env, napi_typeof(env, element, &type));
+    if (type != napi_number) {
+      QUORUM_THROW(env, "fds must be an array of file descriptors");
+    }
+    int32_t fd;
+    QUORUM_TRY(env, napi_get_value_int32(env, element, &fd));
+    if (fd < 0) QUORUM_THROW(env, "fds must be an array of file descriptors");
+    files[index] = (uv_file) fd;
+    // Each source is read into a window before it is calculated:
+    replicas->sources[index] = NULL;
+  }
+  replicas->sourcesLength = fdsLength;
+  replicas->sourceLength = 0;
+  replicas->segmented = 0;
+  replicas->ref_sources = NULL;
+  return fds;
+}
+
+// Parses the options and callback which follow the arguments of each method,
+// then executes the parsed context synchronously or asynchronously:
+static napi_value quorum_run(
+  napi_env env,
+  const size_t argc,
+  napi_value* argv,
+  const size_t first,
+  struct quorum_context* parsed,
+  napi_value sourcesValue,
+  napi_value quorumValue,
+  napi_value targetValue,
+  const int repair
+) {
+  assert(parsed->objects >= 1);
+  // options and callback, either of which may be omitted:
+  napi_value options = NULL;
+  napi_value callback = NULL;
+  if (argc > first) {
+    napi_valuetype optionsType;
+    QUORUM_TRY(env, napi_typeof(env, argv[first], &optionsType));
+    if (argc == first + 1 && optionsType == napi_function) {
+      callback = argv[first];
+    } else if (optionsType == napi_object) {
+      options = argv[first];
+    } else if (optionsType != napi_undefined && optionsType != napi_null) {
+      QUORUM_THROW(env, "options must be an object");
+    }
+  }
+  if (argc > first + 1) {
+    napi_valuetype callbackType;
+    QUORUM_TRY(env, napi_typeof(env, argv[first + 1], &callbackType));
+    if (callbackType == napi_function) {
+      callback = argv[first + 1];
+    } else if (callbackType != napi_undefined) {
+      QUORUM_THROW(env, "callback must be a function");
+    }
+  }
+  // options.threads:
+  napi_value threadsValue;
+  QUORUM_TRY(env, quorum_option(env, options, "threads", &threadsValue));
+  int64_t threads = 1;
+  if (threadsValue != NULL) {
+    QUORUM_TRY(env, napi_get_value_int64(env, threadsValue, &threads));
+    QUORUM_GE(env, threads, 1, "options.threads", "1");
+    QUORUM_LE(
+      env,
+      threads,
+      QUORUM_THREADS_MAX,
+      "options.threads",
+      "THREADS_MAX"
+    );
+  }
+  // options.window (bytes read from each file at a time):
+  int64_t window = 0;
+  if (parsed->files) {
+    napi_value windowValue;
+    QUORUM_TRY(env, quorum_option(env, options, "window", &windowValue));
+    window = QUORUM_WINDOW;
+    if (windowValue != NULL) {
+      QUORUM_TRY(env, napi_get_value_int64(env, windowValue, &window));
+    }
+    QUORUM_GE(env, window, parsed->objectSize, "options.window", "objectSize");
+    QUORUM_LE(env, window, QUORUM_WINDOW_MAX, "options.window", "WINDOW_MAX");
+    // Read whole objects:
+    window -= window % parsed->objectSize;
+  }
+  // options.depth (windows of reads in flight for each file):
+  int64_t depth = QUORUM_DEPTH;
+  bool uring = true;
+  if (parsed->files) {
+    napi_value depthValue;
+    QUORUM_TRY(env, quorum_option(env, options, "depth", &depthValue));
+    if (depthValue != NULL) {
+      QUORUM_TRY(env, napi_get_value_int64(env, depthValue, &depth));
+    }
+    QUORUM_GE(env, depth, 1, "options.depth", "1");
+    QUORUM_LE(env, depth, QUORUM_DEPTH_MAX, "options.depth", "DEPTH_MAX");
+    // options.uring (false to read with pread() on a pool of threads):
+    napi_value uringValue;
+    QUORUM_TRY(env, quorum_option(env, options, "uring", &uringValue));
+    if (uringValue != NULL) {
+      QUORUM_TRY(env, napi_get_value_bool(env, uringValue, &uring));
+    }
+  }
+  // options.stream (gather and decide vectors a block of objects at a time):
+  napi_value streamValue;
+  QUORUM_TRY(env, quorum_option(env, options, "stream", &streamValue));
+  bool stream = false;
+  if (streamValue != NULL) {
+    QUORUM_TRY(env, napi_get_value_bool(env, streamValue, &stream));
+  }
+  // options.leaders:
+  napi_value leadersValue;
+  uint8_t* leaders;
+  QUORUM_OPTION_ARRAY(
+    env,
+    options,
+    "leaders",
+    parsed->objects,
+    "(sourceSize / objectSize)",
+    leadersValue,
+    leaders
+  );
+  // options.members:
+  napi_value membersValue;
+  uint8_t* members;
+  QUORUM_OPTION_ARRAY(
+    env,
+    options,
+    "members",
+    parsed->objects * QUORUM_BITMAP,
+    "(sourceSize / objectSize * BITMAP)",
+    membersValue,
+    members
+  );
+  // options.lagging:
+  napi_value laggingValue;
+  uint8_t* lagging;
+  QUORUM_OPTION_ARRAY(
+    env,
+    options,
+    "lagging",
+    parsed->objects * QUORUM_BITMAP,
+    "(sourceSize / objectSize * BITMAP)",
+    laggingValue,
+    lagging
+  );
+  // options.cache:
+  napi_value cacheValue;
+  uint8_t* cache;
+  QUORUM_OPTION_ARRAY(
+    env,
+    options,
+    "cache",
+    parsed->objects * QUORUM_CACHE,
+    "(sourceSize / objectSize * CACHE)",
+    cacheValue,
+    cache
+  );
+  // Unchanged objects keep their previous results in the quorum buffer:
+  if (cache != NULL && parsed->quorum == NULL) {
+    QUORUM_THROW(env, "options.cache requires a quorum buffer");
+  }
+  // options.changed:
+  napi_value changedValue;
+  uint8_t* changed;
+  QUORUM_OPTION_ARRAY(
+    env,
+    options,
+    "changed",
+    parsed->objects,
+    "(sourceSize / objectSize)",
+    changedValue,
+    changed
+  );
+  // Each result is compared with the previous result in the quorum buffer:
+  if (changed != NULL && parsed->quorum == NULL) {
+    QUORUM_THROW(env, "options.changed requires a quorum buffer");
+  }
+  // options.stats:
+  napi_value statsValue;
+  QUORUM_TRY(env, quorum_option(env, options, "stats", &statsValue));
+  double* stats = NULL;
+  if (statsValue != NULL) {
+    bool statsIsTypedArray;
+    QUORUM_TRY(env, napi_is_typedarray(env, statsValue, &statsIsTypedArray));
+    if (!statsIsTypedArray) {
+      QUORUM_THROW(env, "options.stats must be a Float64Array");
+    }
+    napi_typedarray_type statsType;
+    size_t statsLength;
+    QUORUM_TRY(
+      env,
+      napi_get_typedarray_info(
+        env,
+        statsValue,
+        &statsType,
+        &statsLength,
+        (void**) &stats,
+        NULL,
+        NULL
+      )
+    );
+    if (statsType != napi_float64_array) {
+      QUORUM_THROW(env, "options.stats must be a Float64Array");
+    }
+    QUORUM_GE(
+      env,
+      (int64_t) statsLength,
+      QUORUM_STATS,
+      "options.stats.length",
+      "STATS"
+    );
+  }
+  // options.sparse (an entry for each object which is not unanimous):
+  napi_value sparseValue;
+  uint8_t* sparse;
+  QUORUM_OPTION_ARRAY(
+    env,
+    options,
+    "sparse",
+    QUORUM_SPARSE,
+    "SPARSE",
+    sparseValue,
+    sparse
+  );
+  int64_t sparseCapacity = 0;
+  if (sparse != NULL) {
+    uint8_t* sparseData;
+    size_t sparseLength;
+    QUORUM_TRY(
+      env,
+      napi_get_typedarray_info(
+        env,
+        sparseValue,
+        NULL,
+        &sparseLength,
+        (void**) &sparseData,
+        NULL,
+        NULL
+      )
+    );
+    sparseCapacity = ((int64_t) sparseLength - (sparse - sparseData)) /
+      QUORUM_SPARSE;
+    if (parsed->objects > UINT32_MAX) {
+      QUORUM_THROW(env, "options.sparse supports at most UINT32_MAX objects");
+    }
+    // repair() already returns the number of replicas repaired per object:
+    if (repair) {
+      QUORUM_THROW(env, "options.sparse is not supported by repair()");
+    }
+  }
+  // options.checksum (offset of the CRC32C within each object):
+  napi_value checksumValue;
+  QUORUM_TRY(env, quorum_option(env, options, "checksum", &checksumValue));
+  int64_t checksum = -1;
+  if (checksumValue != NULL) {
+    QUORUM_TRY(env, napi_get_value_int64(env, checksumValue, &checksum));
+    QUORUM_GE(env, checksum, 0, "options.checksum", "0");
+    QUORUM_LE(
+      env,
+      checksum,
+      parsed->objectSize - QUORUM_CHECKSUM,
+      "options.checksum",
+      "objectSize - CHECKSUM"
+    );
+    if (
+      checksum + QUORUM_CHECKSUM > parsed->vectorOffset &&
+      checksum < parsed->vectorOffset + QUORUM_VECTOR
+    ) {
+      QUORUM_THROW(env, "options.checksum must not overlap the vector");
+    }
+    // A cached object is not read again, so would not be verified:
+    if (cache != NULL) {
+      QUORUM_THROW(env, "options.checksum is not supported with options.cache");
+    }
+  }
+  // options.rejected (the number of replicas which failed their checksum):
+  napi_value rejectedValue;
+  uint8_t* rejected;
+  QUORUM_OPTION_ARRAY(
+    env,
+    options,
+    "rejected",
+    parsed->objects,
+    "(sourceSize / objectSize)",
+    rejectedValue,
+    rejected
   );
+  if (rejected != NULL && checksum < 0) {
+    QUORUM_THROW(env, "options.rejected requires options.checksum");
+  }
+  // options.chunk (objects per async work item, to share the libuv pool):
+  napi_value chunkValue;
+  QUORUM_TRY(env, quorum_option(env, options, "chunk", &chunkValue));
+  int64_t chunk = 0;
+  if (chunkValue != NULL) {
+    QUORUM_TRY(env, napi_get_value_int64(env, chunkValue, &chunk));
+    QUORUM_GE(env, chunk, 1, "options.chunk", "1");
+  }
+  // options.progress:
+  napi_value progressValue;
+  QUORUM_TRY(env, quorum_option(env, options, "progress", &progressValue));
+  if (progressValue != NULL) {
+    napi_valuetype progressType;
+    QUORUM_TRY(env, napi_typeof(env, progressValue, &progressType));
+    if (progressType != napi_function) {
+      QUORUM_THROW(env, "options.progress must be a function");
+    }
+  }
+  // options.signal (an AbortSignal, or any object with an aborted property):
+  napi_value signalValue;
+  QUORUM_TRY(env, quorum_option(env, options, "signal", &signalValue));
+  if (signalValue != NULL) {
+    napi_valuetype signalType;
+    QUORUM_TRY(env, napi_typeof(env, signalValue, &signalType));
+    if (signalType != napi_object) {
+      QUORUM_THROW(env, "options.signal must be an object");
+    }
+  }
+  // The other options have a byte or a bit for each replica, or assume that
+  // there are at most SOURCES_MAX replicas:
+  if (
+    parsed->wide &&
+    (
+      stream ||
+      leaders != NULL ||
+      members != NULL ||
+      lagging != NULL ||
+      cache != NULL ||
+      changed != NULL ||
+      stats != NULL ||
+      sparse != NULL ||
+      checksum >= 0
+    )
+  ) {
+    QUORUM_THROW(
+      env,
+      "calculateWide() supports only threads, chunk, progress and signal"
+    );
+  }
+  // repair() returns the number of replicas rewritten for each object:
+  napi_value repairedValue = NULL;
+  uint8_t* repaired = NULL;
+  if (repair) {
+    QUORUM_TRY(
+      env,
+      napi_create_buffer(
+        env,
+        parsed->objects,
+        (void**) &repaired,
+        &repairedValue
+      )
+    );
+  }
+  parsed->leaders = leaders;
+  parsed->members = members;
+  parsed->lagging = lagging;
+  parsed->repaired = repaired;
+  parsed->cache = cache;
+  parsed->changed = changed;
+  parsed->stream = stream ? 1 : 0;
+  parsed->stats = stats;
+  parsed->sparse.entries = sparse;
+  parsed->sparse.capacity = sparseCapacity;
+  parsed->sparse.length = 0;
+  parsed->sparseBase = 0;
+  parsed->checksum = checksum;
+  parsed->rejected = rejected;
+  parsed->begin = 0;
+  parsed->end = parsed->objects;
+  parsed->chunk = chunk;
+  parsed->threads = threads;
+  parsed->window = window;
+  parsed->depth = depth;
+  parsed->uring = uring ? 1 : 0;
+  parsed->rewritten = NULL;
+  // No callback (synchronous):
+  if (callback == NULL) {
+    if (!quorum_extents(parsed)) {
+      QUORUM_THROW(env, "extents allocation failed");
+    }
+    if (
+      parsed->segmented &&
+      !quorum_segments(env, parsed, sourcesValue, targetValue)
+    ) {
+      quorum_extents_free(parsed);
+      QUORUM_THROW(env, "segments changed or allocation failed");
+    }
+    if (parsed->wide && !quorum_wide_sources(env, parsed, sourcesValue)) {
+      quorum_extents_free(parsed);
+      QUORUM_THROW(env, "sources changed or allocation failed");
+    }
+    int error = quorum_execute(
+      parsed,
+      sparse != NULL ? &parsed->sparse : NULL
+    );
+    quorum_extents_free(parsed);
+    if (error) {
+      assert(napi_throw(env, quorum_error(env, error)) == napi_ok);
+      return NULL;
+    }
+    // The number of objects which are not unanimous, even beyond capacity:
+    if (sparse != NULL) {
+      napi_value sparseCount;
+      QUORUM_TRY(
+        env,
+        napi_create_int64(env, parsed->sparse.length, &sparseCount)
+      );
+      return sparseCount;
+    }
+    return repairedValue;
+  }
+  struct quorum_context* ctx = quorum_pool_acquire(&quorum_context_pool);
+  if (!ctx) QUORUM_THROW(env, "context allocation failed");
+  *ctx = *parsed;
+  if (!quorum_extents(ctx)) {
+    quorum_pool_release(&quorum_context_pool, ctx);
+    QUORUM_THROW(env, "extents allocation failed");
+  }
+  if (
+    ctx->segmented &&
+    !quorum_segments(env, ctx, sourcesValue, targetValue)
+  ) {
+    quorum_extents_free(ctx);
+    quorum_pool_release(&quorum_context_pool, ctx);
+    QUORUM_THROW(env, "segments changed or allocation failed");
+  }
+  if (ctx->wide && !quorum_wide_sources(env, ctx, sourcesValue)) {
+    quorum_extents_free(ctx);
+    quorum_pool_release(&quorum_context_pool, ctx);
+    QUORUM_THROW(env, "sources changed or allocation failed");
+  }
+  ctx->error = QUORUM_ERROR_UNDEFINED;
+  if (chunk > 0 && chunk < ctx->objects) ctx->end = chunk;
   assert(
-    napi_create_string_utf8(
+    napi_create_reference(env, sourcesValue, 1, &ctx->ref_sources) == napi_ok
+  );
+  ctx->ref_quorum = NULL;
+  ctx->ref_target = NULL;
+  ctx->ref_leaders = NULL;
+  ctx->ref_members = NULL;
+  ctx->ref_lagging = NULL;
+  ctx->ref_repaired = NULL;
+  ctx->ref_cache = NULL;
+  ctx->ref_changed = NULL;
+  ctx->ref_stats = NULL;
+  ctx->ref_sparse = NULL;
+  ctx->ref_rejected = NULL;
+  ctx->ref_progress = NULL;
+  ctx->ref_signal = NULL;
+  if (quorumValue != NULL) {
+    assert(
+      napi_create_reference(env, quorumValue, 1, &ctx->ref_quorum) == napi_ok
+    );
+  }
+  if (targetValue != NULL) {
+    assert(
+      napi_create_reference(env, targetValue, 1, &ctx->ref_target) == napi_ok
+    );
+  }
+  if (leaders != NULL) {
+    assert(
+      napi_create_reference(env, leadersValue, 1, &ctx->ref_leaders) == napi_ok
+    );
+  }
+  if (members != NULL) {
+    assert(
+      napi_create_reference(env, membersValue, 1, &ctx->ref_members) == napi_ok
+    );
+  }
+  if (lagging != NULL) {
+    assert(
+      napi_create_reference(env, laggingValue, 1, &ctx->ref_lagging) == napi_ok
+    );
+  }
+  if (repaired != NULL) {
+    assert(
+      napi_create_reference(env, repairedValue, 1, &ctx->ref_repaired) ==
+      napi_ok
+    );
+  }
+  if (cache != NULL) {
+    assert(
+      napi_create_reference(env, cacheValue, 1, &ctx->ref_cache) == napi_ok
+    );
+  }
+  if (changed != NULL) {
+    assert(
+      napi_create_reference(env, changedValue, 1, &ctx->ref_changed) == napi_ok
+    );
+  }
+  if (stats != NULL) {
+    assert(
+      napi_create_reference(env, statsValue, 1, &ctx->ref_stats) == napi_ok
+    );
+  }
+  if (sparseValue != NULL) {
+    assert(
+      napi_create_reference(env, sparseValue, 1, &ctx->ref_sparse) == napi_ok
+    );
+  }
+  if (rejected != NULL) {
+    assert(
+      napi_create_reference(env, rejectedValue, 1, &ctx->ref_rejected) ==
+      napi_ok
+    );
+  }
+  if (progressValue != NULL) {
+    assert(
+      napi_create_reference(env, progressValue, 1, &ctx->ref_progress) ==
+      napi_ok
+    );
+  }
+  if (signalValue != NULL) {
+    assert(
+      napi_create_reference(env, signalValue, 1, &ctx->ref_signal) == napi_ok
+    );
+  }
+  assert(
+    napi_create_reference(env, callback, 1, &ctx->ref_callback) == napi_ok
+  );
+  quorum_async_queue(env, ctx);
+  return NULL;
+}
+
+void quorum_export_constant(
+  napi_env env,
+  napi_value exports,
+  const char* key,
+  const int64_t value
+) {
+  napi_value number;
+  assert(value >= INT32_MIN);
+  assert(value <= INT32_MAX);
+  assert(napi_create_int32(env, (int32_t) value, &number) == napi_ok);
+  assert(napi_set_named_property(env, exports, key, number) == napi_ok);
+}
+
+
+// Shared by calculate() and repair(), which take the same arguments, and by
+// their ReplicaSet methods, for which the sources are already parsed:
+static napi_value quorum_method(
+  napi_env env,
+  const size_t argc,
+  napi_value* argv,
+  struct quorum_replicas* replicas,
+  const int mode
+) {
+  quorum_kernels_use();
+  QUORUM_GE(env, argc, 9, "arguments.length", "9");
+  QUORUM_LE(env, argc, 11, "arguments.length", "11");
+  // vectorOffset:
+  int64_t vectorOffset;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[0], &vectorOffset));
+  QUORUM_GE(env, vectorOffset, 0, "vectorOffset", "0");
+  // objectSize:
+  int64_t objectSize;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[1], &objectSize));
+  QUORUM_GE(env, objectSize, 0, "objectSize", "0");
+  QUORUM_GE(env, objectSize, QUORUM_VECTOR, "objectSize", "VECTOR");
+  QUORUM_GE(
+    env,
+    objectSize,
+    vectorOffset + QUORUM_VECTOR,
+    "objectSize",
+    "vectorOffset + VECTOR"
+  );
+  // sourceOffset:
+  int64_t sourceOffset;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[2], &sourceOffset));
+  QUORUM_GE(env, sourceOffset, 0, "sourceOffset", "0");
+  // sourceSize:
+  int64_t sourceSize;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[3], &sourceSize));
+  QUORUM_GE(env, sourceSize, 0, "sourceSize", "0");
+  QUORUM_GE(env, sourceSize, objectSize, "sourceSize", "objectSize");
+  if (sourceSize % objectSize) {
+    QUORUM_THROW(env, "sourceSize must be a multiple of objectSize");
+  }
+  // sources (or fds):
+  const int files = (
+    mode == QUORUM_MODE_FILES ||
+    mode == QUORUM_MODE_REPAIR_FILES
+  );
+  struct quorum_replicas parsedReplicas;
+  uv_file fds[255];
+  if (files) {
+    if (quorum_fds(env, argv[4], fds, &parsedReplicas) == NULL) return NULL;
+    replicas = &parsedReplicas;
+  } else if (mode == QUORUM_MODE_WIDE) {
+    if (quorum_sources_wide(env, argv[4], &parsedReplicas) == NULL) {
+      return NULL;
+    }
+    replicas = &parsedReplicas;
+  } else if (replicas == NULL) {
+    if (quorum_sources(env, argv[4], &parsedReplicas) == NULL) return NULL;
+    replicas = &parsedReplicas;
+  }
+  const int64_t sourcesLength = replicas->sourcesLength;
+  uint8_t** sources = replicas->sources;
+  if (!files) {
+    QUORUM_GE(
       env,
-      "vectors must not have cyclic references",
-      NAPI_AUTO_LENGTH,
-      &message
-    ) == napi_ok
+      (int64_t) replicas->sourceLength,
+      sourceOffset + sourceSize,
+      "source.length",
+      "sourceOffset + sourceSize"
+    );
+  }
+  // quorum (may be null):
+  napi_valuetype quorumType;
+  QUORUM_TRY(env, napi_typeof(env, argv[5], &quorumType));
+  uint8_t* quorum = NULL;
+  size_t quorumLength = 0;
+  if (quorumType != napi_null) {
+    bool quorumIsBuffer;
+    QUORUM_TRY(env, napi_is_buffer(env, argv[5], &quorumIsBuffer));
+    if (!quorumIsBuffer) QUORUM_THROW(env, "quorum must be a buffer");
+    QUORUM_TRY(
+      env,
+      napi_get_buffer_info(env, argv[5], (void**) &quorum, &quorumLength)
+    );
+  }
+  // quorumOffset:
+  int64_t quorumOffset;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[6], &quorumOffset));
+  QUORUM_GE(env, quorumOffset, 0, "quorumOffset", "0");
+  if (quorum != NULL && mode == QUORUM_MODE_WIDE) {
+    QUORUM_GE(
+      env,
+      (int64_t) quorumLength,
+      quorumOffset + (sourceSize / objectSize * QUORUM_WIDE_SIZE),
+      "quorum.length",
+      "quorumOffset + (sourceSize / objectSize * WIDE_SIZE)"
+    );
+  } else if (quorum != NULL) {
+    QUORUM_GE(
+      env,
+      (int64_t) quorumLength,
+      quorumOffset + (sourceSize / objectSize * QUORUM_SIZE),
+      "quorum.length",
+      "quorumOffset + (sourceSize / objectSize * QUORUM_SIZE)"
+    );
+  }
+  // target (may be null):
+  napi_valuetype targetType;
+  QUORUM_TRY(env, napi_typeof(env, argv[7], &targetType));
+  uint8_t* target = NULL;
+  int64_t targetLength = 0;
+  int targetSegmented = 0;
+  if (targetType != napi_null) {
+    // The target may also be an array of buffer segments:
+    QUORUM_TRY(
+      env,
+      quorum_segments_length(
+        env,
+        argv[7],
+        &target,
+        &targetLength,
+        &targetSegmented
+      )
+    );
+    if (
+      targetLength < 0 ||
+      (
+        targetSegmented &&
+        (files || mode == QUORUM_MODE_WIDE)
+      )
+    ) {
+      QUORUM_THROW(env, "target must be a buffer");
+    }
+  }
+  // targetOffset:
+  int64_t targetOffset;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[8], &targetOffset));
+  QUORUM_GE(env, targetOffset, 0, "targetOffset", "0");
+  if (target != NULL || targetSegmented) {
+    QUORUM_GE(
+      env,
+      targetLength,
+      targetOffset + sourceSize,
+      "target.length",
+      "targetOffset + sourceSize"
+    );
+  }
+  // A single extent:
+  uint8_t descriptor[QUORUM_EXTENT];
+  quorum_descriptor(
+    descriptor,
+    sourceOffset,
+    sourceSize,
+    quorumOffset,
+    targetOffset
+  );
+  struct quorum_context parsed;
+  parsed.vectorOffset = vectorOffset;
+  parsed.objectSize = objectSize;
+  // The sources of calculateWide() are read again by quorum_run():
+  if (mode != QUORUM_MODE_WIDE) {
+    for (int64_t index = 0; index < sourcesLength; index++) {
+      parsed.sources[index] = sources[index];
+    }
+  }
+  parsed.wide = mode == QUORUM_MODE_WIDE;
+  parsed.wideSources = NULL;
+  parsed.sourcesLength = sourcesLength;
+  parsed.quorum = quorum;
+  parsed.target = target;
+  parsed.descriptors = descriptor;
+  parsed.extentsLength = 1;
+  parsed.objects = sourceSize / objectSize;
+  parsed.files = files;
+  parsed.segmented = replicas->segmented || targetSegmented;
+  parsed.targetSegmented = targetSegmented;
+  parsed.segments = NULL;
+  if (parsed.files) {
+    for (int64_t index = 0; index < sourcesLength; index++) {
+      parsed.fds[index] = fds[index];
+    }
+  }
+  return quorum_run(
+    env,
+    argc,
+    argv,
+    9,
+    &parsed,
+    argv[4],
+    quorum != NULL ? argv[5] : NULL,
+    target != NULL || targetSegmented ? argv[7] : NULL,
+    mode == QUORUM_MODE_REPAIR || mode == QUORUM_MODE_REPAIR_FILES
   );
-  napi_create_error(env, code, message, &result);
-  return result;
 }
 
-void quorum_async_execute(napi_env env, void* data) {
-  struct quorum_context* ctx = data;
-  assert(ctx->error != QUORUM_ERROR_COMPLETED);
-  assert(ctx->error == QUORUM_ERROR_UNDEFINED);
-  ctx->error = quorum_iterate(
-    ctx->vectorOffset,
-    ctx->objectSize,
-    ctx->sourceSize,
-    ctx->sources,
-    ctx->sourcesLength,
-    ctx->quorum,
-    ctx->target
+static napi_value quorum_batch(
+  napi_env env,
+  const size_t argc,
+  napi_value* argv,
+  struct quorum_replicas* replicas
+) {
+  quorum_kernels_use();
+  QUORUM_GE(env, argc, 6, "arguments.length", "6");
+  QUORUM_LE(env, argc, 8, "arguments.length", "8");
+  // vectorOffset:
+  int64_t vectorOffset;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[0], &vectorOffset));
+  QUORUM_GE(env, vectorOffset, 0, "vectorOffset", "0");
+  // objectSize:
+  int64_t objectSize;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[1], &objectSize));
+  QUORUM_GE(env, objectSize, 0, "objectSize", "0");
+  QUORUM_GE(env, objectSize, QUORUM_VECTOR, "objectSize", "VECTOR");
+  QUORUM_GE(
+    env,
+    objectSize,
+    vectorOffset + QUORUM_VECTOR,
+    "objectSize",
+    "vectorOffset + VECTOR"
+  );
+  // sources:
+  struct quorum_replicas parsedReplicas;
+  if (replicas == NULL) {
+    if (quorum_sources(env, argv[2], &parsedReplicas) == NULL) return NULL;
+    replicas = &parsedReplicas;
+  }
+  // Extents index into each source directly:
+  if (replicas->segmented) {
+    QUORUM_THROW(env, "sources must be an array of buffers");
+  }
+  const int64_t sourcesLength = replicas->sourcesLength;
+  uint8_t** sources = replicas->sources;
+  const size_t sourceLength0 = replicas->sourceLength;
+  // extents:
+  bool extentsIsBuffer;
+  QUORUM_TRY(env, napi_is_buffer(env, argv[3], &extentsIsBuffer));
+  if (!extentsIsBuffer) QUORUM_THROW(env, "extents must be a buffer");
+  uint8_t* extents;
+  size_t extentsSize;
+  QUORUM_TRY(
+    env,
+    napi_get_buffer_info(env, argv[3], (void**) &extents, &extentsSize)
+  );
+  QUORUM_GE(env, extentsSize, QUORUM_EXTENT, "extents.length", "EXTENT");
+  if (extentsSize % QUORUM_EXTENT) {
+    QUORUM_THROW(env, "extents.length must be a multiple of EXTENT");
+  }
+  // quorum (may be null):
+  napi_valuetype quorumType;
+  QUORUM_TRY(env, napi_typeof(env, argv[4], &quorumType));
+  uint8_t* quorum = NULL;
+  size_t quorumLength = 0;
+  if (quorumType != napi_null) {
+    bool quorumIsBuffer;
+    QUORUM_TRY(env, napi_is_buffer(env, argv[4], &quorumIsBuffer));
+    if (!quorumIsBuffer) QUORUM_THROW(env, "quorum must be a buffer");
+    QUORUM_TRY(
+      env,
+      napi_get_buffer_info(env, argv[4], (void**) &quorum, &quorumLength)
+    );
+  }
+  // target (may be null):
+  napi_valuetype targetType;
+  QUORUM_TRY(env, napi_typeof(env, argv[5], &targetType));
+  uint8_t* target = NULL;
+  size_t targetLength = 0;
+  if (targetType != napi_null) {
+    bool targetIsBuffer;
+    QUORUM_TRY(env, napi_is_buffer(env, argv[5], &targetIsBuffer));
+    if (!targetIsBuffer) QUORUM_THROW(env, "target must be a buffer");
+    QUORUM_TRY(
+      env,
+      napi_get_buffer_info(env, argv[5], (void**) &target, &targetLength)
+    );
+  }
+  // Validate every extent up front, comparing sizes without overflow:
+  const int64_t extentsLength = (int64_t) (extentsSize / QUORUM_EXTENT);
+  int64_t objects = 0;
+  for (int64_t index = 0; index < extentsLength; index++) {
+    const uint8_t* descriptor = extents + index * QUORUM_EXTENT;
+    const uint64_t sourceOffset = quorum_read_uint64(descriptor + 0);
+    const uint64_t sourceSize = quorum_read_uint64(descriptor + 8);
+    const uint64_t quorumOffset = quorum_read_uint64(descriptor + 16);
+    const uint64_t targetOffset = quorum_read_uint64(descriptor + 24);
+    if (sourceSize < (uint64_t) objectSize) {
+      QUORUM_THROW(env, "extent.sourceSize must be at least objectSize");
+    }
+    if (sourceSize % (uint64_t) objectSize) {
+      QUORUM_THROW(env, "extent.sourceSize must be a multiple of objectSize");
+    }
+    if (
+      sourceOffset > sourceLength0 ||
+      sourceSize > sourceLength0 - sourceOffset
+    ) {
+      QUORUM_THROW(
+        env,
+        "source.length must be at least extent.sourceOffset + extent.sourceSize"
+      );
+    }
+    const uint64_t quorumSize = sourceSize / objectSize * QUORUM_SIZE;
+    if (
+      quorum != NULL &&
+      (quorumOffset > quorumLength || quorumSize > quorumLength - quorumOffset)
+    ) {
+      QUORUM_THROW(
+        env,
+        "quorum.length must be at least extent.quorumOffset + "
+        "(extent.sourceSize / objectSize * QUORUM_SIZE)"
+      );
+    }
+    if (
+      target != NULL &&
+      (targetOffset > targetLength || sourceSize > targetLength - targetOffset)
+    ) {
+      QUORUM_THROW(
+        env,
+        "target.length must be at least extent.targetOffset + extent.sourceSize"
+      );
+    }
+    objects += (int64_t) (sourceSize / objectSize);
+  }
+  struct quorum_context parsed;
+  parsed.vectorOffset = vectorOffset;
+  parsed.objectSize = objectSize;
+  for (int64_t index = 0; index < sourcesLength; index++) {
+    parsed.sources[index] = sources[index];
+  }
+  parsed.sourcesLength = sourcesLength;
+  parsed.quorum = quorum;
+  parsed.target = target;
+  parsed.descriptors = extents;
+  parsed.extentsLength = extentsLength;
+  parsed.objects = objects;
+  parsed.files = 0;
+  parsed.wide = 0;
+  parsed.wideSources = NULL;
+  parsed.segmented = 0;
+  parsed.targetSegmented = 0;
+  parsed.segments = NULL;
+  return quorum_run(
+    env,
+    argc,
+    argv,
+    6,
+    &parsed,
+    argv[2],
+    quorum != NULL ? argv[4] : NULL,
+    target != NULL ? argv[5] : NULL,
+    0
   );
-  assert(ctx->error == 0 || ctx->error == 1);
 }
 
-void quorum_async_complete(napi_env env, napi_status status, void* data) {
-  struct quorum_context* ctx = data;
-  assert(ctx->error != QUORUM_ERROR_COMPLETED);
-  assert(ctx->error != QUORUM_ERROR_UNDEFINED);
-  assert(ctx->error == 0 || ctx->error == 1);
-  napi_value scope;
-  assert(napi_get_global(env, &scope) == napi_ok);
-  napi_value callback;
-  assert(
-    napi_get_reference_value(env, ctx->ref_callback, &callback) == napi_ok
-  );
-  int argc = 0;
-  napi_value argv[1];
-  if (ctx->error) argv[argc++] = quorum_error(env, ctx->error);
-  ctx->error = QUORUM_ERROR_COMPLETED;
-  // Do not assert the return status of napi_call_function():
-  // If the user throws our error, then the return status will not be napi_ok.
-  napi_value result;
-  napi_call_function(env, scope, callback, argc, argv, &result);
-  assert(napi_delete_reference(env, ctx->ref_sources) == napi_ok);
-  assert(napi_delete_reference(env, ctx->ref_quorum) == napi_ok);
-  assert(napi_delete_reference(env, ctx->ref_target) == napi_ok);
-  assert(napi_delete_reference(env, ctx->ref_callback) == napi_ok);
-  assert(napi_delete_async_work(env, ctx->async_work) == napi_ok);
-  free(ctx);
-  ctx = NULL;
+static napi_value quorum_calculate(napi_env env, napi_callback_info info) {
+  size_t argc = 11;
+  napi_value argv[11];
+  QUORUM_TRY(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  return quorum_method(env, argc, argv, NULL, QUORUM_MODE_CALCULATE);
+}
+
+static napi_value quorum_repair(napi_env env, napi_callback_info info) {
+  size_t argc = 11;
+  napi_value argv[11];
+  QUORUM_TRY(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  return quorum_method(env, argc, argv, NULL, QUORUM_MODE_REPAIR);
+}
+
+static napi_value quorum_calculate_wide(
+  napi_env env,
+  napi_callback_info info
+) {
+  size_t argc = 11;
+  napi_value argv[11];
+  QUORUM_TRY(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  return quorum_method(env, argc, argv, NULL, QUORUM_MODE_WIDE);
+}
+
+static napi_value quorum_calculate_files(
+  napi_env env,
+  napi_callback_info info
+) {
+  size_t argc = 11;
+  napi_value argv[11];
+  QUORUM_TRY(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  return quorum_method(env, argc, argv, NULL, QUORUM_MODE_FILES);
+}
+
+static napi_value quorum_repair_files(
+  napi_env env,
+  napi_callback_info info
+) {
+  size_t argc = 11;
+  napi_value argv[11];
+  QUORUM_TRY(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  return quorum_method(env, argc, argv, NULL, QUORUM_MODE_REPAIR_FILES);
+}
+
+static napi_value quorum_calculate_batch(
+  napi_env env,
+  napi_callback_info info
+) {
+  size_t argc = 8;
+  napi_value argv[8];
+  QUORUM_TRY(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  return quorum_batch(env, argc, argv, NULL);
+}
+
+static inline int quorum_zero(const uint8_t* id) {
+  uint64_t x[2];
+  memcpy(x, id, QUORUM_ID);
+  return (x[0] | x[1]) == 0;
 }
 
-static napi_value quorum_calculate(napi_env env, napi_callback_info info) {
-  size_t argc = 10;
-  napi_value argv[10];
+// The same invariants as Quorum.update() in index.js, with the same messages:
+static const char* quorum_update_check(
+  const uint8_t* vector,
+  const uint8_t* id
+) {
+  if (quorum_zero(vector)) return "vector[0] must not be zero";
+  if (quorum_zero(vector + QUORUM_ID)) return "vector[1] must not be zero";
+  if (quorum_equal(vector, vector + QUORUM_ID)) {
+    return "vector[0] must not equal vector[1]";
+  }
+  if (quorum_zero(id)) return "id must not be zero";
+  if (quorum_equal(id, vector)) return "id must not equal vector[0]";
+  if (quorum_equal(id, vector + QUORUM_ID)) {
+    return "id must not equal vector[1]";
+  }
+  return NULL;
+}
+
+static napi_value quorum_update_many(napi_env env, napi_callback_info info) {
+  size_t argc = 7;
+  napi_value argv[7];
   QUORUM_TRY(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
-  QUORUM_GE(env, argc, 9, "arguments.length", "9");
-  QUORUM_LE(env, argc, 10, "arguments.length", "10");
+  QUORUM_GE(env, argc, 6, "arguments.length", "6");
+  QUORUM_LE(env, argc, 6, "arguments.length", "6");
   // vectorOffset:
   int64_t vectorOffset;
   QUORUM_TRY(env, napi_get_value_int64(env, argv[0], &vectorOffset));
@@ -448,7 +4629,6 @@ static napi_value quorum_calculate(napi_env env, napi_callback_info info) {
   // objectSize:
   int64_t objectSize;
   QUORUM_TRY(env, napi_get_value_int64(env, argv[1], &objectSize));
-  QUORUM_GE(env, objectSize, 0, "objectSize", "0");
   QUORUM_GE(env, objectSize, QUORUM_VECTOR, "objectSize", "VECTOR");
   QUORUM_GE(
     env,
@@ -464,192 +4644,402 @@ static napi_value quorum_calculate(napi_env env, napi_callback_info info) {
   // sourceSize:
   int64_t sourceSize;
   QUORUM_TRY(env, napi_get_value_int64(env, argv[3], &sourceSize));
-  QUORUM_GE(env, sourceSize, 0, "sourceSize", "0");
   QUORUM_GE(env, sourceSize, objectSize, "sourceSize", "objectSize");
   if (sourceSize % objectSize) {
     QUORUM_THROW(env, "sourceSize must be a multiple of objectSize");
   }
-  // sources:
-  bool sourcesIsArray;
-  QUORUM_TRY(env, napi_is_array(env, argv[4], &sourcesIsArray));
-  if (!sourcesIsArray) QUORUM_THROW(env, "sources must be an array");
-  uint32_t sourcesLengthU32;
-  QUORUM_TRY(env, napi_get_array_length(env, argv[4], &sourcesLengthU32));
-  int64_t sourcesLength = (int64_t) sourcesLengthU32;
+  // source:
+  bool sourceIsBuffer;
+  QUORUM_TRY(env, napi_is_buffer(env, argv[4], &sourceIsBuffer));
+  if (!sourceIsBuffer) QUORUM_THROW(env, "source must be a buffer");
+  uint8_t* source;
+  size_t sourceLength;
+  QUORUM_TRY(
+    env,
+    napi_get_buffer_info(env, argv[4], (void**) &source, &sourceLength)
+  );
   QUORUM_GE(
     env,
-    sourcesLength,
-    QUORUM_SOURCES_MIN,
-    "sources.length",
-    "SOURCES_MIN"
+    (int64_t) sourceLength,
+    sourceOffset + sourceSize,
+    "source.length",
+    "sourceOffset + sourceSize"
   );
-  QUORUM_LE(
+  // ids (a single ID for every object, or an ID for each object):
+  const int64_t objects = sourceSize / objectSize;
+  bool idsIsBuffer;
+  QUORUM_TRY(env, napi_is_buffer(env, argv[5], &idsIsBuffer));
+  if (!idsIsBuffer) QUORUM_THROW(env, "ids must be a buffer");
+  uint8_t* ids;
+  size_t idsLength;
+  QUORUM_TRY(
     env,
-    sourcesLength,
-    QUORUM_SOURCES_MAX,
-    "sources.length",
-    "SOURCES_MAX"
+    napi_get_buffer_info(env, argv[5], (void**) &ids, &idsLength)
   );
-  QUORUM_LE(env, sourcesLength, UINT8_MAX, "sources.length", "UINT8_MAX");
-  QUORUM_LE(env, sourcesLength, 255, "sources.length", "255");
-  size_t sourceLength0;
-  uint8_t* sources[255];
-  for (int64_t index = 0; index < sourcesLength; index++) {
-    napi_value element;
-    QUORUM_TRY(env, napi_get_element(env, argv[4], index, &element));
-    bool sourceIsBuffer;
-    QUORUM_TRY(env, napi_is_buffer(env, element, &sourceIsBuffer));
-    if (!sourceIsBuffer) {
-      QUORUM_THROW(env, "sources must be an array of buffers");
-    }
-    uint8_t* source;
-    size_t sourceLength;
-    QUORUM_TRY(
+  if (
+    (int64_t) idsLength != QUORUM_ID &&
+    (int64_t) idsLength != objects * QUORUM_ID
+  ) {
+    QUORUM_THROW(
       env,
-      napi_get_buffer_info(env, element, (void**) &source, &sourceLength)
+      "ids.length must be ID or (sourceSize / objectSize * ID)"
     );
-    QUORUM_GE(
-      env,
-      (int64_t) sourceLength,
-      sourceOffset + sourceSize,
-      "source.length",
-      "sourceOffset + sourceSize"
+  }
+  const int64_t idsStride = (int64_t) idsLength == QUORUM_ID ? 0 : QUORUM_ID;
+  uint8_t* vectors = source + sourceOffset + vectorOffset;
+  // Validate every vector before updating any, so that a transaction is
+  // either applied to all objects or to none:
+  for (int64_t object = 0; object < objects; object++) {
+    const char* message = quorum_update_check(
+      vectors + object * objectSize,
+      ids + object * idsStride
     );
-    if (index == 0) {
-      sourceLength0 = sourceLength;
-    } else if (sourceLength != sourceLength0) {
-      QUORUM_THROW(env, "sources must have the same length");
-    }
-    sources[index] = source + sourceOffset;
+    if (message == NULL) continue;
+    napi_value messageValue;
+    napi_value objectValue;
+    napi_value error;
+    assert(
+      napi_create_string_utf8(env, message, NAPI_AUTO_LENGTH, &messageValue) ==
+      napi_ok
+    );
+    assert(napi_create_error(env, NULL, messageValue, &error) == napi_ok);
+    assert(napi_create_int64(env, object, &objectValue) == napi_ok);
+    assert(
+      napi_set_named_property(env, error, "object", objectValue) == napi_ok
+    );
+    assert(napi_throw(env, error) == napi_ok);
+    return NULL;
   }
-  // quorum:
-  bool quorumIsBuffer;
-  QUORUM_TRY(env, napi_is_buffer(env, argv[5], &quorumIsBuffer));
-  if (!quorumIsBuffer) QUORUM_THROW(env, "quorum must be a buffer");
-  uint8_t* quorum;
-  size_t quorumLength;
-  QUORUM_TRY(
-    env,
-    napi_get_buffer_info(env, argv[5], (void**) &quorum, &quorumLength)
-  );
-  // quorumOffset:
-  int64_t quorumOffset;
-  QUORUM_TRY(env, napi_get_value_int64(env, argv[6], &quorumOffset));
-  QUORUM_GE(env, quorumOffset, 0, "quorumOffset", "0");
+  // Copy ID 0 to ID 1 and set ID 0 to the new ID:
+  for (int64_t object = 0; object < objects; object++) {
+    uint8_t* vector = vectors + object * objectSize;
+    memcpy(vector + QUORUM_ID, vector, QUORUM_ID);
+    memcpy(vector, ids + object * idsStride, QUORUM_ID);
+  }
+  return argv[4];
+}
+
+// Writes the CRC32C of every object at checksumOffset, for options.checksum:
+static napi_value quorum_checksum_many(
+  napi_env env,
+  napi_callback_info info
+) {
+  size_t argc = 5;
+  napi_value argv[5];
+  QUORUM_TRY(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  quorum_kernels_use();
+  QUORUM_GE(env, argc, 5, "arguments.length", "5");
+  // checksumOffset:
+  int64_t checksumOffset;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[0], &checksumOffset));
+  QUORUM_GE(env, checksumOffset, 0, "checksumOffset", "0");
+  // objectSize:
+  int64_t objectSize;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[1], &objectSize));
   QUORUM_GE(
     env,
-    (int64_t) quorumLength,
-    quorumOffset + (sourceSize / objectSize * QUORUM_SIZE),
-    "quorum.length",
-    "quorumOffset + (sourceSize / objectSize * QUORUM_SIZE)"
+    objectSize,
+    checksumOffset + QUORUM_CHECKSUM,
+    "objectSize",
+    "checksumOffset + CHECKSUM"
   );
-  quorum += quorumOffset;
-  // target:
-  bool targetIsBuffer;
-  QUORUM_TRY(env, napi_is_buffer(env, argv[7], &targetIsBuffer));
-  if (!targetIsBuffer) QUORUM_THROW(env, "target must be a buffer");
-  uint8_t* target;
-  size_t targetLength;
+  // sourceOffset:
+  int64_t sourceOffset;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[2], &sourceOffset));
+  QUORUM_GE(env, sourceOffset, 0, "sourceOffset", "0");
+  // sourceSize:
+  int64_t sourceSize;
+  QUORUM_TRY(env, napi_get_value_int64(env, argv[3], &sourceSize));
+  QUORUM_GE(env, sourceSize, objectSize, "sourceSize", "objectSize");
+  if (sourceSize % objectSize) {
+    QUORUM_THROW(env, "sourceSize must be a multiple of objectSize");
+  }
+  // source:
+  bool sourceIsBuffer;
+  QUORUM_TRY(env, napi_is_buffer(env, argv[4], &sourceIsBuffer));
+  if (!sourceIsBuffer) QUORUM_THROW(env, "source must be a buffer");
+  uint8_t* source;
+  size_t sourceLength;
   QUORUM_TRY(
     env,
-    napi_get_buffer_info(env, argv[7], (void**) &target, &targetLength)
+    napi_get_buffer_info(env, argv[4], (void**) &source, &sourceLength)
   );
-  // targetOffset:
-  int64_t targetOffset;
-  QUORUM_TRY(env, napi_get_value_int64(env, argv[8], &targetOffset));
-  QUORUM_GE(env, targetOffset, 0, "targetOffset", "0");
   QUORUM_GE(
     env,
-    (int64_t) targetLength,
-    targetOffset + sourceSize,
-    "target.length",
-    "targetOffset + sourceSize"
+    (int64_t) sourceLength,
+    sourceOffset + sourceSize,
+    "source.length",
+    "sourceOffset + sourceSize"
   );
-  target += targetOffset;
-  // No callback (synchronous):
-  if (argc < 10) {
-    int error = quorum_iterate(
-      vectorOffset,
-      objectSize,
-      sourceSize,
-      sources,
-      sourcesLength,
-      quorum,
-      target
-    );
-    if (error) assert(napi_throw(env, quorum_error(env, error)) == napi_ok);
-    return NULL;
+  const int64_t objects = sourceSize / objectSize;
+  for (int64_t object = 0; object < objects; object++) {
+    uint8_t* buffer = source + sourceOffset + object * objectSize;
+    const uint32_t crc = quorum_checksum(buffer, objectSize, checksumOffset);
+    for (int index = 0; index < QUORUM_CHECKSUM; index++) {
+      buffer[checksumOffset + index] = (uint8_t) (crc >> (index * 8));
+    }
   }
-  // callback:
-  napi_valuetype callbackType;
-  QUORUM_TRY(env, napi_typeof(env, argv[9], &callbackType));
-  if (callbackType != napi_function) {
-    QUORUM_THROW(env, "callback must be a function");
+  return argv[4];
+}
+
+// Selects a narrower kernel than the CPU supports, so that the tests can run
+// every kernel on one machine. The kernels are read without synchronization,
+// so this is for tests only, and fails once any method may have used them:
+static napi_value quorum_set_kernel(napi_env env, napi_callback_info info) {
+  size_t argc = 1;
+  napi_value argv[1];
+  QUORUM_TRY(env, napi_get_cb_info(env, info, &argc, argv, NULL, NULL));
+  QUORUM_GE(env, argc, 1, "arguments.length", "1");
+  napi_valuetype type;
+  QUORUM_TRY(env, napi_typeof(env, argv[0], &type));
+  if (type != napi_string) QUORUM_THROW(env, "kernel must be a string");
+  // Longer strings are truncated, and then never match exactly:
+  char kernel[16];
+  size_t kernelLength;
+  QUORUM_TRY(
+    env,
+    napi_get_value_string_utf8(
+      env,
+      argv[0],
+      kernel,
+      sizeof(kernel),
+      &kernelLength
+    )
+  );
+  const int native = strcmp(kernel, "native") == 0;
+  const int scalar = strcmp(kernel, "scalar") == 0;
+#if defined(QUORUM_SSE2)
+  const int sse2 = strcmp(kernel, "sse2") == 0;
+#else
+  const int sse2 = 0;
+#endif
+  const int generic = strcmp(kernel, "generic") == 0;
+  if (!native && !scalar && !sse2 && !generic) {
+    QUORUM_THROW(env, "kernel must be native, scalar, sse2 or generic");
   }
-  struct quorum_context* ctx = malloc(sizeof(struct quorum_context));
-  if (!ctx) QUORUM_THROW(env, "context allocation failed");
-  ctx->vectorOffset = vectorOffset;
-  ctx->objectSize = objectSize;
-  ctx->sourceSize = sourceSize;
-  for (int64_t index = 0; index < sourcesLength; index++) {
-    ctx->sources[index] = sources[index];
+  // Each kernel sets every pointer, so that none depends on an earlier call:
+  uv_mutex_lock(&quorum_kernels_mutex);
+  const int used = quorum_kernels_used;
+  if (!used) {
+    if (native || generic) {
+      quorum_kernels_native();
+      quorum_fast_generic = generic;
+    } else {
+      // SSE2 has no CRC32C instruction, so sse2 keeps the scalar CRC32C:
+      quorum_kernels_scalar();
+#if defined(QUORUM_SSE2)
+      if (sse2) quorum_classify = quorum_classify_sse2;
+#endif
+    }
   }
-  ctx->sourcesLength = sourcesLength;
-  ctx->quorum = quorum;
-  ctx->target = target;
-  ctx->error = QUORUM_ERROR_UNDEFINED;
-  napi_value resource_name;
+  uv_mutex_unlock(&quorum_kernels_mutex);
+  if (used) QUORUM_THROW(env, "kernel must be selected before any calculation");
+  return NULL;
+}
+
+static void quorum_replicas_finalize(napi_env env, void* data, void* hint) {
+  (void) hint;
+  struct quorum_replicas* replicas = data;
+  assert(napi_delete_reference(env, replicas->ref_sources) == napi_ok);
+  free(replicas);
+}
+
+static napi_value quorum_replicas_constructor(
+  napi_env env,
+  napi_callback_info info
+) {
+  size_t argc = 1;
+  napi_value argv[1];
+  napi_value self;
+  QUORUM_TRY(env, napi_get_cb_info(env, info, &argc, argv, &self, NULL));
+  napi_value target;
+  QUORUM_TRY(env, napi_get_new_target(env, info, &target));
+  if (target == NULL) QUORUM_THROW(env, "ReplicaSet must be called with new");
+  QUORUM_GE(env, argc, 1, "arguments.length", "1");
+  // Pin a copy of the array, so that the caller may reuse the original, and
+  // validate the copy rather than the original, since a getter could return
+  // a different buffer each time an element is read:
+  napi_value pinned = argv[0];
+  bool isArray;
+  QUORUM_TRY(env, napi_is_array(env, argv[0], &isArray));
+  uint32_t length = 0;
+  if (isArray) {
+    QUORUM_TRY(env, napi_get_array_length(env, argv[0], &length));
+  }
+  if (isArray && length <= QUORUM_SOURCES_MAX) {
+    QUORUM_TRY(env, napi_create_array_with_length(env, length, &pinned));
+    for (uint32_t index = 0; index < length; index++) {
+      napi_value element;
+      QUORUM_TRY(env, napi_get_element(env, argv[0], index, &element));
+      QUORUM_TRY(env, napi_set_element(env, pinned, index, element));
+    }
+  }
+  struct quorum_replicas parsed;
+  if (quorum_sources(env, pinned, &parsed) == NULL) return NULL;
+  assert(pinned != argv[0]);
+  if (parsed.segmented) {
+    QUORUM_THROW(env, "sources must be an array of buffers");
+  }
+  struct quorum_replicas* replicas = malloc(sizeof(struct quorum_replicas));
+  if (!replicas) QUORUM_THROW(env, "replicas allocation failed");
+  *replicas = parsed;
   assert(
-    napi_create_string_utf8(
-      env,
-      "@ronomon/quorum",
-      NAPI_AUTO_LENGTH,
-      &resource_name
-    ) == napi_ok
+    napi_create_reference(env, pinned, 1, &replicas->ref_sources) == napi_ok
   );
-  assert(napi_create_reference(env, argv[4], 1, &ctx->ref_sources) == napi_ok);
-  assert(napi_create_reference(env, argv[5], 1, &ctx->ref_quorum) == napi_ok);
-  assert(napi_create_reference(env, argv[7], 1, &ctx->ref_target) == napi_ok);
-  assert(napi_create_reference(env, argv[9], 1, &ctx->ref_callback) == napi_ok);
-  assert(
-    napi_create_async_work(
-      env,
-      NULL,
-      resource_name,
-      quorum_async_execute,
-      quorum_async_complete,
-      ctx,
-      &ctx->async_work
-    ) == napi_ok
+  napi_status status = napi_wrap(
+    env,
+    self,
+    replicas,
+    quorum_replicas_finalize,
+    NULL,
+    NULL
   );
-  assert(napi_queue_async_work(env, ctx->async_work) == napi_ok);
-  return NULL;
+  if (status != napi_ok) {
+    assert(napi_delete_reference(env, replicas->ref_sources) == napi_ok);
+    free(replicas);
+    QUORUM_TRY(env, status);
+  }
+  return self;
 }
 
-void quorum_export_constant(
+// Gets the arguments of a ReplicaSet method, inserting the replica set where
+// the equivalent Quorum method would take the sources. Returns the replica
+// set (or NULL if an exception is pending):
+static napi_value quorum_replicas_arguments(
   napi_env env,
-  napi_value exports,
-  const char* key,
-  const int64_t value
+  napi_callback_info info,
+  size_t* argc,
+  napi_value* argv,
+  const size_t position,
+  struct quorum_replicas** replicas
 ) {
-  napi_value number;
-  assert(value >= INT32_MIN);
-  assert(value <= INT32_MAX);
-  assert(napi_create_int32(env, (int32_t) value, &number) == napi_ok);
-  assert(napi_set_named_property(env, exports, key, number) == napi_ok);
+  assert(*argc >= position + 1);
+  assert(*argc <= 11);
+  size_t length = *argc - 1;
+  napi_value args[11];
+  napi_value self;
+  QUORUM_TRY(env, napi_get_cb_info(env, info, &length, args, &self, NULL));
+  QUORUM_TRY(env, napi_unwrap(env, self, (void**) replicas));
+  const size_t capacity = *argc - 1;
+  for (size_t index = 0; index < length && index < capacity; index++) {
+    argv[index < position ? index : index + 1] = args[index];
+  }
+  argv[position] = self;
+  *argc = length + 1;
+  return self;
+}
+
+static napi_value quorum_replicas_calculate(
+  napi_env env,
+  napi_callback_info info
+) {
+  size_t argc = 11;
+  napi_value argv[11];
+  struct quorum_replicas* replicas;
+  napi_value self = quorum_replicas_arguments(
+    env,
+    info,
+    &argc,
+    argv,
+    4,
+    &replicas
+  );
+  if (self == NULL) return NULL;
+  QUORUM_GE(env, argc - 1, 8, "arguments.length", "8");
+  QUORUM_LE(env, argc - 1, 10, "arguments.length", "10");
+  return quorum_method(env, argc, argv, replicas, QUORUM_MODE_CALCULATE);
+}
+
+static napi_value quorum_replicas_repair(
+  napi_env env,
+  napi_callback_info info
+) {
+  size_t argc = 11;
+  napi_value argv[11];
+  struct quorum_replicas* replicas;
+  napi_value self = quorum_replicas_arguments(
+    env,
+    info,
+    &argc,
+    argv,
+    4,
+    &replicas
+  );
+  if (self == NULL) return NULL;
+  QUORUM_GE(env, argc - 1, 8, "arguments.length", "8");
+  QUORUM_LE(env, argc - 1, 10, "arguments.length", "10");
+  return quorum_method(env, argc, argv, replicas, QUORUM_MODE_REPAIR);
+}
+
+static napi_value quorum_replicas_calculate_batch(
+  napi_env env,
+  napi_callback_info info
+) {
+  size_t argc = 8;
+  napi_value argv[8];
+  struct quorum_replicas* replicas;
+  napi_value self = quorum_replicas_arguments(
+    env,
+    info,
+    &argc,
+    argv,
+    2,
+    &replicas
+  );
+  if (self == NULL) return NULL;
+  QUORUM_GE(env, argc - 1, 5, "arguments.length", "5");
+  QUORUM_LE(env, argc - 1, 7, "arguments.length", "7");
+  return quorum_batch(env, argc, argv, replicas);
 }
 
 static napi_value Init(napi_env env, napi_value exports) {
+  // Init() runs once for each thread or worker which loads the module:
+  uv_once(&quorum_pool_once, quorum_pool_init);
+  uv_once(&quorum_crc32c_once, quorum_crc32c_init);
+  uv_once(&quorum_kernels_once, quorum_kernels);
   // Test constants:
   assert(QUORUM_SOURCES_MIN > 0);
   assert(QUORUM_SOURCES_MIN < QUORUM_SOURCES_MAX);
   assert(QUORUM_SOURCES_MAX > 0);
   assert(QUORUM_SOURCES_MAX <= 255);
   assert(QUORUM_SOURCES_MAX <= UINT8_MAX);
-  assert(QUORUM_ID == 16); // Required by quorum_equal() for loop unrolling.
-  assert(QUORUM_NODE == 4 + QUORUM_VECTOR);
+  assert(QUORUM_THREADS_MAX >= 1);
+  assert(QUORUM_THREAD_OBJECTS >= 1);
+  assert(QUORUM_ID == 16); // Required by quorum_equal() for 128-bit lanes.
+  assert(QUORUM_NODE == 4 + QUORUM_ID + sizeof(uint32_t));
   assert(QUORUM_NODES == QUORUM_NODE * 2 * QUORUM_SOURCES_MAX);
+  assert((QUORUM_SLOTS & (QUORUM_SLOTS - 1)) == 0);
+  assert(QUORUM_SLOTS >= 2 * 2 * QUORUM_SOURCES_MAX);
+  assert(QUORUM_SLOTS <= UINT16_MAX);
+  assert(QUORUM_NODES % 2 == 0); // Slots must be aligned for uint16_t.
+  assert(quorum_slots(QUORUM_SOURCES_MAX) == QUORUM_SLOTS);
+  assert((QUORUM_NODES + QUORUM_SLOTS * 2) % 4 == 0); // Aligns the stack.
+  assert(QUORUM_STACK * QUORUM_NODE == QUORUM_NODES);
+  assert(QUORUM_NODES <= UINT16_MAX); // Owners are 16-bit node offsets.
+  assert(QUORUM_BITMAP * 8 >= QUORUM_SOURCES_MAX);
+  assert(QUORUM_EXTENT == 4 * sizeof(uint64_t));
+  assert(QUORUM_CACHE == sizeof(uint64_t));
+  assert(QUORUM_STATS_FAST == 0);
+  assert(
+    sizeof(quorum_fast_fixed_kernels) / sizeof(quorum_fast_fixed_kernels[0]) ==
+    QUORUM_FIXED_MAX + 1
+  );
+  assert(QUORUM_STATS_ORDERED < QUORUM_STATS_LENGTH);
+  assert(QUORUM_STATS_CHAINS < QUORUM_STATS_LENGTH);
+  assert(QUORUM_STATS_LENGTH + UINT8_MAX < QUORUM_STATS_REPAIR);
+  assert(QUORUM_STATS_REPAIR + UINT8_MAX < QUORUM_STATS);
+  assert(QUORUM_NODES <= UINT32_MAX);
+  assert(
+    QUORUM_SCRATCH ==
+    QUORUM_NODES +
+    QUORUM_SLOTS * sizeof(uint16_t) +
+    QUORUM_STACK * sizeof(uint32_t) +
+    QUORUM_OWNERS * sizeof(uint16_t)
+  );
   assert(QUORUM_VECTOR == 32);
+  assert(QUORUM_STREAM >= QUORUM_VECTOR * QUORUM_SOURCES_MAX);
+  assert(QUORUM_STREAM_OBJECTS >= 1);
+  assert(QUORUM_STREAM_AHEAD >= 1);
   assert(QUORUM_VECTOR == QUORUM_ID * 2);
   assert(QUORUM_DEPENDENT > 0);
   assert(QUORUM_TEMPORARY > 0);
@@ -668,6 +5058,8 @@ static napi_value Init(napi_env env, napi_value exports) {
   assert(QUORUM_LENGTH_OFFSET != QUORUM_FORKED_OFFSET);
   assert(QUORUM_REPAIR_OFFSET != QUORUM_FORKED_OFFSET);
   assert(QUORUM_SIZE == 4);
+  assert(QUORUM_LEADER_NONE >= QUORUM_SOURCES_MAX); // Never a valid leader.
+  assert(QUORUM_LEADER_NONE <= UINT8_MAX);
   // Test quorum_equal():
   uint8_t a[16];
   uint8_t b[16];
@@ -684,6 +5076,100 @@ static napi_value Init(napi_env env, napi_value exports) {
     b[offset] = offset;
     assert(quorum_equal(a, b) == 1);
   }
+  // Test quorum_classify() kernels:
+  quorum_classify_kernel kernels[] = {
+    quorum_classify,
+    quorum_classify_scalar,
+#if defined(QUORUM_SSE2)
+    quorum_classify_sse2,
+#endif
+#if defined(QUORUM_AVX2)
+    __builtin_cpu_supports("avx2") ? quorum_classify_avx2 : NULL,
+#endif
+  };
+  const uint8_t ids[][2] = {
+    { 1, 2 },
+    { 1, 2 },
+    { 3, 3 },
+    { 2, 4 },
+    { 5, 1 },
+    { 6, 7 },
+    { 1, 1 },
+    { 2, 1 }
+  };
+  const uint8_t expect[] = {
+    QUORUM_EQUAL,
+    QUORUM_EQUAL,
+    QUORUM_CYCLIC,
+    QUORUM_ORDERED,
+    QUORUM_ORDERED,
+    0,
+    QUORUM_CYCLIC | QUORUM_EQUAL | QUORUM_ORDERED,
+    QUORUM_ORDERED
+  };
+  const int vectorsLength = sizeof(expect);
+  uint8_t vectorsBuffer[sizeof(expect) * QUORUM_VECTOR];
+  uint8_t* vectors[sizeof(expect)];
+  for (int index = 0; index < vectorsLength; index++) {
+    vectors[index] = vectorsBuffer + index * QUORUM_VECTOR;
+    memset(vectors[index], ids[index][0], QUORUM_ID);
+    memset(vectors[index] + QUORUM_ID, ids[index][1], QUORUM_ID);
+  }
+  for (int k = 0; k < (int) (sizeof(kernels) / sizeof(kernels[0])); k++) {
+    if (kernels[k] == NULL) continue;
+    uint8_t classes[sizeof(expect)];
+    kernels[k](vectors, vectorsLength, 0, vectors[0], classes);
+    for (int index = 0; index < vectorsLength; index++) {
+      assert(classes[index] == expect[index]);
+    }
+  }
+  // Test quorum_crc32c() kernels against the check value of CRC32C, and
+  // against each other for every alignment and tail length:
+  quorum_crc32c_kernel crc32cKernels[] = {
+    quorum_crc32c,
+    quorum_crc32c_scalar,
+#if defined(QUORUM_SSE42)
+    __builtin_cpu_supports("sse4.2") ? quorum_crc32c_sse42 : NULL,
+#endif
+#if defined(QUORUM_ARM_CRC32)
+    quorum_crc32c_arm,
+#endif
+  };
+  uint8_t crc32cData[64];
+  for (int index = 0; index < 64; index++) {
+    crc32cData[index] = (uint8_t) (index * 31 + 7);
+  }
+  for (
+    int k = 0;
+    k < (int) (sizeof(crc32cKernels) / sizeof(crc32cKernels[0]));
+    k++
+  ) {
+    if (crc32cKernels[k] == NULL) continue;
+    const uint8_t* check = (const uint8_t*) "123456789";
+    assert(~crc32cKernels[k](0xFFFFFFFF, check, 9) == 0xE3069283);
+    for (int offset = 0; offset < 8; offset++) {
+      for (int length = 0; length <= 64 - offset; length += 5) {
+        assert(
+          crc32cKernels[k](0xFFFFFFFF, crc32cData + offset, length) ==
+          quorum_crc32c_scalar(0xFFFFFFFF, crc32cData + offset, length)
+        );
+      }
+    }
+  }
+  for (int offset = 0; offset < 8; offset++) {
+    for (int length = 0; length <= 56; length += 5) {
+      uint32_t crc[3] = { 0xFFFFFFFF, 1, 2 };
+      const uint8_t* data[3] = {
+        crc32cData + offset,
+        crc32cData + offset / 2,
+        crc32cData + 8 - offset
+      };
+      quorum_crc32c_x3(crc, data, length);
+      assert(crc[0] == quorum_crc32c_scalar(0xFFFFFFFF, data[0], length));
+      assert(crc[1] == quorum_crc32c_scalar(1, data[1], length));
+      assert(crc[2] == quorum_crc32c_scalar(2, data[2], length));
+    }
+  }
   // Exports:
   napi_value method;
   assert(
@@ -691,8 +5177,87 @@ static napi_value Init(napi_env env, napi_value exports) {
     napi_ok
   );
   assert(napi_set_named_property(env, exports, "calculate", method) == napi_ok);
+  assert(
+    napi_create_function(env, NULL, 0, quorum_repair, NULL, &method) ==
+    napi_ok
+  );
+  assert(napi_set_named_property(env, exports, "repair", method) == napi_ok);
+  assert(
+    napi_create_function(env, NULL, 0, quorum_calculate_batch, NULL, &method) ==
+    napi_ok
+  );
+  assert(
+    napi_set_named_property(env, exports, "calculateBatch", method) == napi_ok
+  );
+  assert(
+    napi_create_function(env, NULL, 0, quorum_calculate_files, NULL, &method) ==
+    napi_ok
+  );
+  assert(
+    napi_set_named_property(env, exports, "calculateFiles", method) == napi_ok
+  );
+  assert(
+    napi_create_function(env, NULL, 0, quorum_repair_files, NULL, &method) ==
+    napi_ok
+  );
+  assert(
+    napi_set_named_property(env, exports, "repairFiles", method) == napi_ok
+  );
+  assert(
+    napi_create_function(env, NULL, 0, quorum_calculate_wide, NULL, &method) ==
+    napi_ok
+  );
+  assert(
+    napi_set_named_property(env, exports, "calculateWide", method) == napi_ok
+  );
+  assert(
+    napi_create_function(env, NULL, 0, quorum_update_many, NULL, &method) ==
+    napi_ok
+  );
+  assert(
+    napi_set_named_property(env, exports, "updateMany", method) == napi_ok
+  );
+  assert(
+    napi_create_function(env, NULL, 0, quorum_checksum_many, NULL, &method) ==
+    napi_ok
+  );
+  assert(
+    napi_set_named_property(env, exports, "checksum", method) == napi_ok
+  );
+  assert(
+    napi_create_function(env, NULL, 0, quorum_set_kernel, NULL, &method) ==
+    napi_ok
+  );
+  assert(
+    napi_set_named_property(env, exports, "_setKernel", method) == napi_ok
+  );
+  napi_property_descriptor properties[] = {
+    { "calculate", NULL, quorum_replicas_calculate, NULL, NULL, NULL,
+      napi_default, NULL },
+    { "calculateBatch", NULL, quorum_replicas_calculate_batch, NULL, NULL,
+      NULL, napi_default, NULL },
+    { "repair", NULL, quorum_replicas_repair, NULL, NULL, NULL,
+      napi_default, NULL }
+  };
+  napi_value replicaSet;
+  assert(
+    napi_define_class(
+      env,
+      "ReplicaSet",
+      NAPI_AUTO_LENGTH,
+      quorum_replicas_constructor,
+      NULL,
+      sizeof(properties) / sizeof(properties[0]),
+      properties,
+      &replicaSet
+    ) == napi_ok
+  );
+  assert(
+    napi_set_named_property(env, exports, "ReplicaSet", replicaSet) == napi_ok
+  );
   quorum_export_constant(env, exports, "SOURCES_MIN", QUORUM_SOURCES_MIN);
   quorum_export_constant(env, exports, "SOURCES_MAX", QUORUM_SOURCES_MAX);
+  quorum_export_constant(env, exports, "THREADS_MAX", QUORUM_THREADS_MAX);
   quorum_export_constant(env, exports, "ID", QUORUM_ID);
   quorum_export_constant(env, exports, "VECTOR", QUORUM_VECTOR);
   quorum_export_constant(env, exports, "LEADER_OFFSET", QUORUM_LEADER_OFFSET);
@@ -700,6 +5265,58 @@ static napi_value Init(napi_env env, napi_value exports) {
   quorum_export_constant(env, exports, "REPAIR_OFFSET", QUORUM_REPAIR_OFFSET);
   quorum_export_constant(env, exports, "FORKED_OFFSET", QUORUM_FORKED_OFFSET);
   quorum_export_constant(env, exports, "SIZE", QUORUM_SIZE);
+  quorum_export_constant(env, exports, "LEADER_NONE", QUORUM_LEADER_NONE);
+  quorum_export_constant(
+    env,
+    exports,
+    "SOURCES_WIDE_MAX",
+    QUORUM_SOURCES_WIDE_MAX
+  );
+  quorum_export_constant(
+    env,
+    exports,
+    "WIDE_LEADER_OFFSET",
+    QUORUM_WIDE_LEADER_OFFSET
+  );
+  quorum_export_constant(
+    env,
+    exports,
+    "WIDE_LENGTH_OFFSET",
+    QUORUM_WIDE_LENGTH_OFFSET
+  );
+  quorum_export_constant(
+    env,
+    exports,
+    "WIDE_REPAIR_OFFSET",
+    QUORUM_WIDE_REPAIR_OFFSET
+  );
+  quorum_export_constant(
+    env,
+    exports,
+    "WIDE_FORKED_OFFSET",
+    QUORUM_WIDE_FORKED_OFFSET
+  );
+  quorum_export_constant(env, exports, "WIDE_SIZE", QUORUM_WIDE_SIZE);
+  quorum_export_constant(env, exports, "BITMAP", QUORUM_BITMAP);
+  quorum_export_constant(env, exports, "EXTENT", QUORUM_EXTENT);
+  quorum_export_constant(env, exports, "CACHE", QUORUM_CACHE);
+  quorum_export_constant(env, exports, "CHECKSUM", QUORUM_CHECKSUM);
+  quorum_export_constant(env, exports, "SPARSE", QUORUM_SPARSE);
+  quorum_export_constant(env, exports, "STATS", QUORUM_STATS);
+  quorum_export_constant(env, exports, "STATS_FAST", QUORUM_STATS_FAST);
+  quorum_export_constant(env, exports, "STATS_ORDERED", QUORUM_STATS_ORDERED);
+  quorum_export_constant(env, exports, "STATS_CHAINS", QUORUM_STATS_CHAINS);
+  quorum_export_constant(env, exports, "STATS_FORKED", QUORUM_STATS_FORKED);
+  quorum_export_constant(env, exports, "STATS_CYCLIC", QUORUM_STATS_CYCLIC);
+  quorum_export_constant(env, exports, "STATS_CACHED", QUORUM_STATS_CACHED);
+  quorum_export_constant(env, exports, "STATS_FAST_NS", QUORUM_STATS_FAST_NS);
+  quorum_export_constant(env, exports, "STATS_SLOW_NS", QUORUM_STATS_SLOW_NS);
+  quorum_export_constant(env, exports, "STATS_LENGTH", QUORUM_STATS_LENGTH);
+  quorum_export_constant(env, exports, "STATS_REPAIR", QUORUM_STATS_REPAIR);
+  quorum_export_constant(env, exports, "WINDOW", QUORUM_WINDOW);
+  quorum_export_constant(env, exports, "WINDOW_MAX", QUORUM_WINDOW_MAX);
+  quorum_export_constant(env, exports, "DEPTH", QUORUM_DEPTH);
+  quorum_export_constant(env, exports, "DEPTH_MAX", QUORUM_DEPTH_MAX);
   return exports;
 }
 
@@ -3,6 +3,11 @@
 var Assert = require('assert');
 var Quorum = require('./binding.node');
 
+// Quorum._setKernel() is internal, for test.js only, and not part of the API:
+// it selects a narrower kernel than the CPU supports, fails once any
+// calculation has begun, and may change or be removed in any release:
+Object.defineProperty(Quorum, '_setKernel', { enumerable: false });
+
 function equal(a, aOffset, b, bOffset) {
   var size = Quorum.ID;
   while (size--) if (a[aOffset++] !== b[bOffset++]) return false;
@@ -71,4 +76,186 @@ Quorum.update = function(vector, vectorOffset, id) {
   return vector;
 };
 
+// Objects per native chunk for Quorum.chunks(), unless options.chunk is given:
+var CHUNK = 65536;
+
+// Returns the length of a source, which may be an array of buffer segments,
+// or -1 if the source is neither (for the native method to reject):
+function sourceLength(source) {
+  if (Buffer.isBuffer(source)) return source.length;
+  if (!Array.isArray(source)) return -1;
+  var length = 0;
+  for (var index = 0; index < source.length; index++) {
+    if (!Buffer.isBuffer(source[index])) return -1;
+    length += source[index].length;
+  }
+  return length;
+}
+
+// Allocates quorum and target buffers for a region, leaving the native method
+// to validate its arguments (and throw the same exceptions) as usual. Nothing
+// is allocated for a region which the first source does not contain, since
+// the native method will refuse it:
+function allocate(objectSize, sourceOffset, sourceSize, sources, options) {
+  var objects = 0;
+  if (
+    Number.isInteger(objectSize) &&
+    Number.isInteger(sourceOffset) &&
+    Number.isInteger(sourceSize) &&
+    Array.isArray(sources) &&
+    sources.length > 0 &&
+    objectSize > 0 &&
+    sourceOffset >= 0 &&
+    sourceSize > 0 &&
+    sourceOffset + sourceSize <= sourceLength(sources[0])
+  ) {
+    objects = Math.floor(sourceSize / objectSize);
+  }
+  return {
+    quorum: Buffer.alloc(objects * Quorum.SIZE),
+    target: (options && options.target === false) ?
+      null : Buffer.alloc(objects * objectSize)
+  };
+}
+
+// Copies options without those which are only understood by the JS methods:
+function nativeOptions(options) {
+  var copy = Object.assign({}, options);
+  delete copy.target;
+  return copy;
+}
+
+Quorum.promises = {};
+
+// Resolves to { quorum, target } buffers for the region. Set options.target to
+// false if only the quorum is needed. With options.sparse, also resolves to
+// sparseLength, the number of objects which are not unanimous:
+Quorum.promises.calculate = function(
+  vectorOffset,
+  objectSize,
+  sourceOffset,
+  sourceSize,
+  sources,
+  options
+) {
+  return new Promise(
+    function(resolve, reject) {
+      var buffers = allocate(
+        objectSize,
+        sourceOffset,
+        sourceSize,
+        sources,
+        options
+      );
+      Quorum.calculate(
+        vectorOffset,
+        objectSize,
+        sourceOffset,
+        sourceSize,
+        sources,
+        buffers.quorum,
+        0,
+        buffers.target,
+        0,
+        nativeOptions(options),
+        function(error, sparseLength) {
+          if (error) return reject(error);
+          if (sparseLength !== undefined) buffers.sparseLength = sparseLength;
+          resolve(buffers);
+        }
+      );
+    }
+  );
+};
+
+// Yields { begin, end, quorum, target } for each chunk of objects as soon as
+// the native chunk completes, while the next chunk is being calculated, where
+// quorum and target are slices of the results for objects begin to end. If
+// the consumer stops early, the remaining chunks are aborted:
+Quorum.chunks = async function*(
+  vectorOffset,
+  objectSize,
+  sourceOffset,
+  sourceSize,
+  sources,
+  options
+) {
+  var buffers = allocate(
+    objectSize,
+    sourceOffset,
+    sourceSize,
+    sources,
+    options
+  );
+  var native = nativeOptions(options);
+  var signal = native.signal;
+  var stopped = false;
+  var ranges = [];
+  var begin = 0;
+  var done = false;
+  var failure = null;
+  var wake = null;
+  function notify() {
+    if (!wake) return;
+    var resolve = wake;
+    wake = null;
+    resolve();
+  }
+  native.chunk = native.chunk || CHUNK;
+  native.progress = function(end, total) {
+    ranges.push([begin, end]);
+    begin = end;
+    if (options && options.progress) options.progress(end, total);
+    notify();
+  };
+  native.signal = {
+    get aborted() {
+      return stopped || Boolean(signal && signal.aborted);
+    }
+  };
+  Quorum.calculate(
+    vectorOffset,
+    objectSize,
+    sourceOffset,
+    sourceSize,
+    sources,
+    buffers.quorum,
+    0,
+    buffers.target,
+    0,
+    native,
+    function(error) {
+      done = true;
+      failure = error || null;
+      notify();
+    }
+  );
+  try {
+    while (true) {
+      if (ranges.length) {
+        var range = ranges.shift();
+        yield {
+          begin: range[0],
+          end: range[1],
+          quorum: buffers.quorum.slice(
+            range[0] * Quorum.SIZE,
+            range[1] * Quorum.SIZE
+          ),
+          target: buffers.target ? buffers.target.slice(
+            range[0] * objectSize,
+            range[1] * objectSize
+          ) : null
+        };
+      } else if (done) {
+        if (failure) throw failure;
+        return;
+      } else {
+        await new Promise(function(resolve) { wake = resolve; });
+      }
+    }
+  } finally {
+    stopped = true;
+  }
+};
+
 module.exports = Quorum;
@@ -1,5 +1,9 @@
 var Assert = require('assert');
+var ChildProcess = require('child_process');
 var Crypto = require('crypto');
+var FS = require('fs');
+var OS = require('os');
+var Path = require('path');
 var Queue = require('@ronomon/queue');
 var Quorum = require('./index.js');
 
@@ -59,6 +63,10 @@ Generate.args = function() {
   args.targetSuffix = Hash(
     args.target.slice(args.targetOffset + args.sourceSize)
   );
+  args.members = RandomBuffer(args.objects * Quorum.BITMAP);
+  args.membersReference = Buffer.alloc(args.objects * Quorum.BITMAP);
+  args.lagging = RandomBuffer(args.objects * Quorum.BITMAP);
+  args.laggingReference = Buffer.alloc(args.objects * Quorum.BITMAP);
   return args;
 };
 
@@ -84,10 +92,29 @@ Generate.argsOverride = function(override) {
   if (override.quorumOffset !== undefined) args[6] = override.quorumOffset;
   if (override.target !== undefined) args[7] = override.target;
   if (override.targetOffset !== undefined) args[8] = override.targetOffset;
-  if (override.callback !== undefined) args[9] = override.callback;
+  if (override.options !== undefined) args[9] = override.options;
+  if (override.callback !== undefined) args[args.length] = override.callback;
   return args;
 };
 
+Generate.extents = function(tuples) {
+  var extents = Buffer.alloc(tuples.length * Quorum.EXTENT);
+  tuples.forEach(
+    function(tuple, index) {
+      Assert(tuple.length === 4);
+      tuple.forEach(
+        function(value, field) {
+          extents.writeBigUInt64LE(
+            BigInt(value),
+            index * Quorum.EXTENT + field * 8
+          );
+        }
+      );
+    }
+  );
+  return extents;
+};
+
 Generate.sources = function(
   vectorOffset,
   objectSize,
@@ -267,12 +294,31 @@ Reference.calculate = function(args) {
   for (var index = 0; index < args.objects; index++) {
     var objectOffset = index * args.objectSize;
     var quorumOffset = args.quorumOffset + (index * 4);
-    self.calculateObject(
+    var chain = self.calculateObject(
       args.sources,
       args.sourceOffset + objectOffset + args.vectorOffset,
       args.quorumReference,
       quorumOffset
     );
+    var bitmapOffset = index * Quorum.BITMAP;
+    chain.forEach(
+      function(vector) {
+        var source = args.sources.indexOf(vector);
+        var byte = bitmapOffset + (source >> 3);
+        args.membersReference[byte] |= 1 << (source & 7);
+        if (
+          vector.compare(
+            chain[0],
+            args.sourceOffset + objectOffset + args.vectorOffset,
+            args.sourceOffset + objectOffset + args.vectorOffset + Quorum.ID,
+            args.sourceOffset + objectOffset + args.vectorOffset,
+            args.sourceOffset + objectOffset + args.vectorOffset + Quorum.ID
+          ) !== 0
+        ) {
+          args.laggingReference[byte] |= 1 << (source & 7);
+        }
+      }
+    );
     if (args.quorumReference[quorumOffset + 1] > 0) {
       args.sources[args.quorumReference[quorumOffset + 0]].copy(
         args.targetReference,
@@ -316,7 +362,9 @@ Reference.calculateObject = function(vectors, offset, quorum, quorumOffset) {
     }
     if (!hash.hasOwnProperty(a)) hash[a] = [];
     hash[a].push(vector);
-    if (a !== b) dependencies[a] = b;
+    // A vector which references itself is a cycle:
+    if (a === b) throw new Error('graph is not a directed acyclic graph');
+    dependencies[a] = b;
   }
   var list = [];
   while (nodes.length) {
@@ -363,11 +411,13 @@ Reference.calculateObject = function(vectors, offset, quorum, quorumOffset) {
     quorum[quorumOffset + 1] = 0;
     quorum[quorumOffset + 2] = 0;
     quorum[quorumOffset + 3] = 0;
+    return [];
   } else if (chains.length > 1 && chains[0].length === chains[1].length) {
     quorum[quorumOffset + 0] = 0;
     quorum[quorumOffset + 1] = 0;
     quorum[quorumOffset + 2] = 0;
     quorum[quorumOffset + 3] = 1;
+    return [];
   } else {
     quorum[quorumOffset + 0] = vectors.indexOf(chains[0][0]);
     quorum[quorumOffset + 1] = chains[0].length;
@@ -382,12 +432,685 @@ Reference.calculateObject = function(vectors, offset, quorum, quorumOffset) {
       }
     );
     quorum[quorumOffset + 3] = 0;
+    return chains[0];
+  }
+};
+
+// Differential fuzz of every engine against the reference, with random
+// histories of versions (run alone with "node test.js --fuzz [kernel]"):
+var Fuzz = {};
+
+Fuzz.ITERATIONS = parseInt(process.env.QUORUM_FUZZ, 10) || 100;
+
+Fuzz.args = function() {
+  var self = this;
+  var args = {};
+  // Mostly few replicas, to cover the fixed kernels and the linear scan of
+  // nodes, otherwise up to SOURCES_MAX:
+  if (Random() < 0.7) {
+    args.sourcesLength = Generate.choose(Quorum.SOURCES_MIN, 17);
+  } else {
+    args.sourcesLength = Generate.choose(
+      Quorum.SOURCES_MIN,
+      Quorum.SOURCES_MAX
+    );
+  }
+  args.unique = Generate.choose(1, 16);
+  args.objects = args.unique;
+  args.threads = Generate.choose(1, 4);
+  if (args.sourcesLength <= 16 && Random() < 0.1) {
+    // Repeat the histories for enough objects to split across threads:
+    args.objects = args.unique * Math.ceil(4096 / args.unique);
+  }
+  args.objectSize = Generate.choose(
+    Quorum.VECTOR,
+    args.objects > 16 || args.sourcesLength > 32 ? 128 : 4096
+  );
+  args.vectorOffset = Generate.choose(0, args.objectSize - Quorum.VECTOR);
+  args.checksum = self.checksum(args.vectorOffset, args.objectSize);
+  args.sourceOffset = Generate.choose(0, 64);
+  args.sourceSize = args.objects * args.objectSize;
+  args.sources = [];
+  var length = args.sourceOffset + args.sourceSize + Generate.choose(0, 64);
+  for (var index = 0; index < args.sourcesLength; index++) {
+    // Every replica has its own payload, so that a wrong leader is caught:
+    var source = RandomBuffer(length);
+    source.INDEX = index;
+    args.sources.push(source);
+  }
+  for (var object = 0; object < args.objects; object++) {
+    var offset = self.offset(args, object);
+    if (object < args.unique) {
+      self.history(args.sources, offset);
+    } else {
+      var from = self.offset(args, object % args.unique);
+      args.sources.forEach(
+        function(source) {
+          source.copy(source, offset, from, from + Quorum.VECTOR);
+        }
+      );
+    }
+  }
+  if (Random() < 0.1) {
+    var object = Math.floor(Random() * args.objects);
+    self.cycle(args.sources, self.offset(args, object));
+  }
+  args.corrupt = Buffer.alloc(args.objects * Quorum.BITMAP);
+  if (args.checksum >= 0) {
+    args.sources.forEach(
+      function(source) {
+        Quorum.checksum(
+          args.checksum,
+          args.objectSize,
+          args.sourceOffset,
+          args.sourceSize,
+          source
+        );
+      }
+    );
+    if (Random() < 0.5) self.corrupt(args);
+  }
+  args.expect = self.reference(args, null);
+  args.expectChecksum = self.reference(args, args.corrupt);
+  return args;
+};
+
+Fuzz.checksum = function(vectorOffset, objectSize) {
+  // Any offset of the checksum which does not overlap the vector, or -1:
+  var offsets = [];
+  for (var offset = 0; offset + Quorum.CHECKSUM <= objectSize; offset++) {
+    if (
+      offset + Quorum.CHECKSUM <= vectorOffset ||
+      offset >= vectorOffset + Quorum.VECTOR
+    ) {
+      offsets.push(offset);
+    }
+  }
+  if (offsets.length === 0 || Random() < 0.2) return -1;
+  return offsets[Math.floor(Random() * offsets.length)];
+};
+
+Fuzz.corrupt = function(args) {
+  var corruptions = Generate.choose(1, args.sourcesLength * 2);
+  while (corruptions--) {
+    var object = Math.floor(Random() * args.objects);
+    var source = Math.floor(Random() * args.sourcesLength);
+    var byte = object * Quorum.BITMAP + (source >> 3);
+    if (args.corrupt[byte] & (1 << (source & 7))) continue;
+    args.corrupt[byte] |= 1 << (source & 7);
+    // Flip a bit of the payload, leaving the vector intact:
+    var offset = Math.floor(Random() * (args.objectSize - Quorum.VECTOR));
+    if (offset >= args.vectorOffset) offset += Quorum.VECTOR;
+    offset += args.sourceOffset + object * args.objectSize;
+    args.sources[source][offset] ^= 1 << Math.floor(Random() * 8);
+  }
+};
+
+Fuzz.cycle = function(sources, offset) {
+  // A vector which references itself, or two or three vectors which
+  // reference each other:
+  var length = Generate.choose(1, Math.min(3, sources.length));
+  var ids = [];
+  while (ids.length < length) ids.push(RandomBuffer(Quorum.ID));
+  var replicas = sources.slice();
+  Generate.shuffle(replicas);
+  for (var index = 0; index < length; index++) {
+    ids[index].copy(replicas[index], offset);
+    ids[(index + 1) % length].copy(replicas[index], offset + Quorum.ID);
+  }
+};
+
+Fuzz.history = function(sources, offset) {
+  // IDs which share their leading bytes all fall into the same hash slot:
+  var prefix = Random() < 0.2 ? RandomBuffer(8) : null;
+  function id() {
+    var buffer = RandomBuffer(Quorum.ID);
+    if (prefix) prefix.copy(buffer, 0);
+    return buffer;
+  }
+  // Each node is the vector of a version, with more than one root if some
+  // replicas were written from scratch:
+  var nodes = [];
+  var roots = Random() < 0.7 ? 1 : Generate.choose(2, 4);
+  while (nodes.length < roots) nodes.push([id(), id()]);
+  var versions = Generate.choose(0, Math.min(64, 2 * sources.length));
+  while (versions--) {
+    // Mostly extend the latest version, otherwise fork an earlier version:
+    if (Random() < 0.7) {
+      var parent = nodes[nodes.length - 1];
+    } else {
+      var parent = nodes[Math.floor(Random() * nodes.length)];
+    }
+    nodes.push([id(), parent[0]]);
+  }
+  var unanimous = Random() < 0.3;
+  sources.forEach(
+    function(source) {
+      // Replicas mostly have recent versions, and some lag far behind:
+      var node = nodes[
+        nodes.length - 1 -
+        (unanimous ? 0 : Math.floor(Math.pow(Random(), 3) * nodes.length))
+      ];
+      node[0].copy(source, offset);
+      node[1].copy(source, offset + Quorum.ID);
+    }
+  );
+};
+
+Fuzz.offset = function(args, object) {
+  return args.sourceOffset + (object * args.objectSize) + args.vectorOffset;
+};
+
+Fuzz.reference = function(args, corrupt) {
+  var self = this;
+  // The results of the reference, calculated over the replicas which are not
+  // corrupt, with leaders and bitmaps referring to the index of each source:
+  var expect = {
+    cyclic: false,
+    quorum: Buffer.alloc(args.objects * Quorum.SIZE),
+    members: Buffer.alloc(args.objects * Quorum.BITMAP),
+    lagging: Buffer.alloc(args.objects * Quorum.BITMAP),
+    target: Buffer.alloc(args.sourceSize)
+  };
+  for (var object = 0; object < args.objects; object++) {
+    var bitmap = object * Quorum.BITMAP;
+    var vectors = args.sources.filter(
+      function(source, index) {
+        if (corrupt === null) return true;
+        return (corrupt[bitmap + (index >> 3)] & (1 << (index & 7))) === 0;
+      }
+    );
+    var offset = self.offset(args, object);
+    var quorumOffset = object * Quorum.SIZE;
+    try {
+      var chain = Reference.calculateObject(
+        vectors,
+        offset,
+        expect.quorum,
+        quorumOffset
+      );
+    } catch (error) {
+      if (error.message !== 'graph is not a directed acyclic graph') {
+        throw error;
+      }
+      expect.cyclic = true;
+      continue;
+    }
+    if (expect.quorum[quorumOffset + Quorum.LENGTH_OFFSET] === 0) continue;
+    var leader = vectors[expect.quorum[quorumOffset + Quorum.LEADER_OFFSET]];
+    expect.quorum[quorumOffset + Quorum.LEADER_OFFSET] = leader.INDEX;
+    chain.forEach(
+      function(vector) {
+        var byte = bitmap + (vector.INDEX >> 3);
+        expect.members[byte] |= 1 << (vector.INDEX & 7);
+        var end = offset + Quorum.ID;
+        if (vector.compare(leader, offset, end, offset, end) !== 0) {
+          expect.lagging[byte] |= 1 << (vector.INDEX & 7);
+        }
+      }
+    );
+    leader.copy(
+      expect.target,
+      object * args.objectSize,
+      args.sourceOffset + object * args.objectSize,
+      args.sourceOffset + (object + 1) * args.objectSize
+    );
+  }
+  return expect;
+};
+
+Fuzz.result = function(args, bitmaps) {
+  // Random contents, so that a result which is not written is caught:
+  return {
+    quorum: RandomBuffer(args.objects * Quorum.SIZE),
+    target: RandomBuffer(args.sourceSize),
+    members: bitmaps ? RandomBuffer(args.objects * Quorum.BITMAP) : null,
+    lagging: bitmaps ? RandomBuffer(args.objects * Quorum.BITMAP) : null
+  };
+};
+
+Fuzz.segments = function(buffer) {
+  var segments = [];
+  var offset = 0;
+  var cuts = Generate.choose(0, 4);
+  while (cuts--) {
+    var end = offset + Math.floor(Random() * (buffer.length - offset));
+    if (end === offset) continue;
+    segments.push(buffer.slice(offset, end));
+    offset = end;
+  }
+  segments.push(buffer.slice(offset));
+  return segments;
+};
+
+Fuzz.test = function(name, args, expect, bitmaps, execute) {
+  var self = this;
+  var result = self.result(args, bitmaps);
+  try {
+    execute(result);
+  } catch (error) {
+    if (expect.cyclic && error.code === 'ERR_CYCLIC_REFERENCES') return;
+    throw error;
+  }
+  if (expect.cyclic) throw new Error(name + ': expected cyclic references');
+  for (var object = 0; object < args.objects; object++) {
+    var a = Inspect.quorum(result.quorum, object * Quorum.SIZE);
+    var b = Inspect.quorum(expect.quorum, object * Quorum.SIZE);
+    if (a !== b) {
+      throw new Error(
+        name + ': OBJECT=' + object + ' ' + a + ' (expected ' + b + ')\n' +
+        Inspect.vectors(args.sources, self.offset(args, object))
+      );
+    }
+  }
+  Assert(result.target.equals(expect.target), name + ': target');
+  if (bitmaps) {
+    Assert(result.members.equals(expect.members), name + ': members');
+    Assert(result.lagging.equals(expect.lagging), name + ': lagging');
+  }
+};
+
+Fuzz.execute = function(args) {
+  var self = this;
+  var expect = args.expect;
+  self.test(
+    'calculate()',
+    args,
+    expect,
+    true,
+    function(result) {
+      Quorum.calculate(
+        args.vectorOffset,
+        args.objectSize,
+        args.sourceOffset,
+        args.sourceSize,
+        args.sources,
+        result.quorum,
+        0,
+        result.target,
+        0,
+        { members: result.members, lagging: result.lagging }
+      );
+    }
+  );
+  self.test(
+    'calculate() with threads and stream',
+    args,
+    expect,
+    true,
+    function(result) {
+      Quorum.calculate(
+        args.vectorOffset,
+        args.objectSize,
+        args.sourceOffset,
+        args.sourceSize,
+        args.sources,
+        result.quorum,
+        0,
+        result.target,
+        0,
+        {
+          threads: args.threads,
+          stream: true,
+          members: result.members,
+          lagging: result.lagging
+        }
+      );
+    }
+  );
+  self.test(
+    'calculate() with leaders and sparse',
+    args,
+    expect,
+    false,
+    function(result) {
+      var leaders = new Uint8Array(args.objects);
+      var sparse = Buffer.alloc(args.objects * Quorum.SPARSE);
+      var count = Quorum.calculate(
+        args.vectorOffset,
+        args.objectSize,
+        args.sourceOffset,
+        args.sourceSize,
+        args.sources,
+        result.quorum,
+        0,
+        result.target,
+        0,
+        { leaders: leaders, sparse: sparse }
+      );
+      var entries = 0;
+      for (var object = 0; object < args.objects; object++) {
+        var offset = object * Quorum.SIZE;
+        var length = expect.quorum[offset + Quorum.LENGTH_OFFSET];
+        Assert(
+          leaders[object] === (
+            length > 0 ?
+            expect.quorum[offset + Quorum.LEADER_OFFSET] :
+            Quorum.LEADER_NONE
+          )
+        );
+        if (
+          length === args.sourcesLength &&
+          expect.quorum[offset + Quorum.REPAIR_OFFSET] === 0
+        ) {
+          continue;
+        }
+        var entry = entries++ * Quorum.SPARSE;
+        Assert(sparse.readUInt32LE(entry) === object);
+        Assert(
+          sparse.slice(entry + 4, entry + Quorum.SPARSE).equals(
+            expect.quorum.slice(offset, offset + Quorum.SIZE)
+          )
+        );
+      }
+      Assert(count === entries);
+    }
+  );
+  self.test(
+    'calculate() with segmented sources',
+    args,
+    expect,
+    true,
+    function(result) {
+      Quorum.calculate(
+        args.vectorOffset,
+        args.objectSize,
+        args.sourceOffset,
+        args.sourceSize,
+        args.sources.map(
+          function(source) {
+            return self.segments(source);
+          }
+        ),
+        result.quorum,
+        0,
+        self.segments(result.target),
+        0,
+        { members: result.members, lagging: result.lagging }
+      );
+    }
+  );
+  self.test(
+    'calculate() with cache',
+    args,
+    expect,
+    true,
+    function(result) {
+      var options = {
+        cache: Buffer.alloc(args.objects * Quorum.CACHE),
+        changed: new Uint8Array(args.objects),
+        members: result.members,
+        lagging: result.lagging
+      };
+      for (var pass = 0; pass < 2; pass++) {
+        // The second pass must keep every result of the first:
+        if (pass === 1) options.stats = new Float64Array(Quorum.STATS);
+        Quorum.calculate(
+          args.vectorOffset,
+          args.objectSize,
+          args.sourceOffset,
+          args.sourceSize,
+          args.sources,
+          result.quorum,
+          0,
+          result.target,
+          0,
+          options
+        );
+      }
+      Assert(options.stats[Quorum.STATS_CACHED] === args.objects);
+      Assert(
+        options.changed.every(
+          function(changed) {
+            return changed === 0;
+          }
+        )
+      );
+    }
+  );
+  self.test(
+    'ReplicaSet.calculate()',
+    args,
+    expect,
+    true,
+    function(result) {
+      var replicaSet = new Quorum.ReplicaSet(args.sources);
+      replicaSet.calculate(
+        args.vectorOffset,
+        args.objectSize,
+        args.sourceOffset,
+        args.sourceSize,
+        result.quorum,
+        0,
+        result.target,
+        0,
+        { members: result.members, lagging: result.lagging }
+      );
+    }
+  );
+  self.test(
+    'calculateBatch()',
+    args,
+    expect,
+    true,
+    function(result) {
+      var tuples = [];
+      var object = 0;
+      while (object < args.objects) {
+        var objects = Generate.choose(1, args.objects - object);
+        tuples.push([
+          args.sourceOffset + object * args.objectSize,
+          objects * args.objectSize,
+          object * Quorum.SIZE,
+          object * args.objectSize
+        ]);
+        object += objects;
+      }
+      Quorum.calculateBatch(
+        args.vectorOffset,
+        args.objectSize,
+        args.sources,
+        Generate.extents(tuples),
+        result.quorum,
+        result.target,
+        { members: result.members, lagging: result.lagging }
+      );
+    }
+  );
+  self.test(
+    'calculateWide()',
+    args,
+    expect,
+    false,
+    function(result) {
+      var wide = Buffer.alloc(args.objects * Quorum.WIDE_SIZE);
+      Quorum.calculateWide(
+        args.vectorOffset,
+        args.objectSize,
+        args.sourceOffset,
+        args.sourceSize,
+        args.sources,
+        wide,
+        0,
+        result.target,
+        0,
+        { threads: args.threads }
+      );
+      for (var object = 0; object < args.objects; object++) {
+        var a = object * Quorum.WIDE_SIZE;
+        var b = object * Quorum.SIZE;
+        [
+          [Quorum.WIDE_LEADER_OFFSET, Quorum.LEADER_OFFSET],
+          [Quorum.WIDE_LENGTH_OFFSET, Quorum.LENGTH_OFFSET],
+          [Quorum.WIDE_REPAIR_OFFSET, Quorum.REPAIR_OFFSET]
+        ].forEach(
+          function(fields) {
+            var value = wide.readUInt16LE(a + fields[0]);
+            Assert(value <= 255);
+            result.quorum[b + fields[1]] = value;
+          }
+        );
+        result.quorum[b + Quorum.FORKED_OFFSET] = (
+          wide[a + Quorum.WIDE_FORKED_OFFSET]
+        );
+      }
+    }
+  );
+  self.test(
+    'repair()',
+    args,
+    expect,
+    true,
+    function(result) {
+      var sources = args.sources.map(
+        function(source) {
+          return Buffer.from(source);
+        }
+      );
+      var repaired = Quorum.repair(
+        args.vectorOffset,
+        args.objectSize,
+        args.sourceOffset,
+        args.sourceSize,
+        sources,
+        result.quorum,
+        0,
+        result.target,
+        0,
+        { members: result.members, lagging: result.lagging }
+      );
+      // Every source without the leader's ID has the leader's object:
+      for (var object = 0; object < args.objects; object++) {
+        var offset = args.sourceOffset + object * args.objectSize;
+        var end = offset + args.objectSize;
+        var id = self.offset(args, object);
+        var length = expect.quorum[object * Quorum.SIZE + Quorum.LENGTH_OFFSET];
+        var leader = args.sources[
+          expect.quorum[object * Quorum.SIZE + Quorum.LEADER_OFFSET]
+        ];
+        var rewritten = 0;
+        sources.forEach(
+          function(source, index) {
+            var original = args.sources[index];
+            if (
+              length === 0 ||
+              original.compare(leader, id, id + Quorum.ID, id, id + Quorum.ID)
+              === 0
+            ) {
+              Assert(source.compare(original, offset, end, offset, end) === 0);
+            } else {
+              Assert(source.compare(leader, offset, end, offset, end) === 0);
+              rewritten++;
+            }
+          }
+        );
+        Assert(repaired[object] === rewritten);
+      }
+    }
+  );
+  if (args.checksum >= 0) {
+    self.test(
+      'calculate() with checksum',
+      args,
+      args.expectChecksum,
+      true,
+      function(result) {
+        var rejected = new Uint8Array(args.objects);
+        Quorum.calculate(
+          args.vectorOffset,
+          args.objectSize,
+          args.sourceOffset,
+          args.sourceSize,
+          args.sources,
+          result.quorum,
+          0,
+          result.target,
+          0,
+          {
+            threads: args.threads,
+            checksum: args.checksum,
+            rejected: rejected,
+            members: result.members,
+            lagging: result.lagging
+          }
+        );
+        for (var object = 0; object < args.objects; object++) {
+          var corrupt = 0;
+          for (var index = 0; index < args.sourcesLength; index++) {
+            var byte = args.corrupt[object * Quorum.BITMAP + (index >> 3)];
+            if (byte & (1 << (index & 7))) corrupt++;
+          }
+          Assert(rejected[object] === corrupt);
+        }
+      }
+    );
+  }
+  if (Random() < 0.2) {
+    var directory = FS.mkdtempSync(Path.join(OS.tmpdir(), 'quorum-'));
+    var paths = args.sources.map(
+      function(source, index) {
+        var path = Path.join(directory, String(index));
+        FS.writeFileSync(path, source);
+        return path;
+      }
+    );
+    var fds = paths.map(
+      function(path) {
+        return FS.openSync(path, 'r');
+      }
+    );
+    try {
+      self.test(
+        'calculateFiles()',
+        args,
+        expect,
+        false,
+        function(result) {
+          Quorum.calculateFiles(
+            args.vectorOffset,
+            args.objectSize,
+            args.sourceOffset,
+            args.sourceSize,
+            fds,
+            result.quorum,
+            0,
+            result.target,
+            0,
+            {
+              window: args.objectSize * Generate.choose(1, args.objects),
+              depth: Generate.choose(1, Quorum.DEPTH_MAX),
+              uring: Random() < 0.5
+            }
+          );
+        }
+      );
+    } finally {
+      fds.forEach(FS.closeSync);
+      paths.forEach(FS.unlinkSync);
+      FS.rmdirSync(directory);
+    }
+  }
+};
+
+Fuzz.run = function(iterations) {
+  var self = this;
+  for (var iteration = 0; iteration < iterations; iteration++) {
+    self.execute(self.args());
   }
 };
 
+if (process.argv.indexOf('--fuzz') !== -1) {
+  // Select the kernel before any calculation, as Quorum._setKernel() needs:
+  var kernel = process.argv[process.argv.indexOf('--fuzz') + 1];
+  if (kernel !== undefined) Quorum._setKernel(kernel);
+  Fuzz.run(Fuzz.ITERATIONS);
+  process.exit(0);
+}
+
 // Test constants and methods:
 Assert(Number.isInteger(Quorum.SOURCES_MIN));
 Assert(Number.isInteger(Quorum.SOURCES_MAX));
+Assert(Number.isInteger(Quorum.THREADS_MAX));
 Assert(Number.isInteger(Quorum.ID));
 Assert(Number.isInteger(Quorum.VECTOR));
 Assert(Number.isInteger(Quorum.LEADER_OFFSET));
@@ -395,6 +1118,32 @@ Assert(Number.isInteger(Quorum.LENGTH_OFFSET));
 Assert(Number.isInteger(Quorum.REPAIR_OFFSET));
 Assert(Number.isInteger(Quorum.FORKED_OFFSET));
 Assert(Number.isInteger(Quorum.SIZE));
+Assert(Number.isInteger(Quorum.LEADER_NONE));
+Assert(Number.isInteger(Quorum.BITMAP));
+Assert(Number.isInteger(Quorum.EXTENT));
+Assert(Number.isInteger(Quorum.CACHE));
+[
+  'STATS',
+  'STATS_FAST',
+  'STATS_ORDERED',
+  'STATS_CHAINS',
+  'STATS_FORKED',
+  'STATS_CYCLIC',
+  'STATS_CACHED',
+  'STATS_FAST_NS',
+  'STATS_SLOW_NS',
+  'STATS_LENGTH',
+  'STATS_REPAIR'
+].forEach(
+  function(key) {
+    Assert(Number.isInteger(Quorum[key]));
+    if (key !== 'STATS') Assert(Quorum[key] < Quorum.STATS);
+  }
+);
+Assert(Quorum.STATS_LENGTH + 256 <= Quorum.STATS_REPAIR);
+Assert(Quorum.STATS_REPAIR + 256 <= Quorum.STATS);
+Assert(Quorum.BITMAP * 8 >= Quorum.SOURCES_MAX);
+Assert(Quorum.LEADER_NONE >= Quorum.SOURCES_MAX);
 Assert(Quorum.ID === 16);
 Assert(Quorum.VECTOR === Quorum.ID * 2);
 Assert(Quorum.LEADER_OFFSET === 0);
@@ -402,8 +1151,22 @@ Assert(Quorum.LENGTH_OFFSET === 1);
 Assert(Quorum.REPAIR_OFFSET === 2);
 Assert(Quorum.FORKED_OFFSET === 3);
 Assert(Quorum.SIZE === 4);
+Assert(Quorum.CACHE === 8);
+Assert(Quorum.SPARSE === 8);
+Assert(Quorum.CHECKSUM === 4);
+Assert(Quorum.DEPTH >= 1);
+Assert(Quorum.DEPTH <= Quorum.DEPTH_MAX);
+Assert(Quorum.SOURCES_WIDE_MAX === 65535);
+Assert(Quorum.WIDE_LEADER_OFFSET === 0);
+Assert(Quorum.WIDE_LENGTH_OFFSET === 2);
+Assert(Quorum.WIDE_REPAIR_OFFSET === 4);
+Assert(Quorum.WIDE_FORKED_OFFSET === 6);
+Assert(Quorum.WIDE_SIZE === 8);
 Assert(typeof Quorum.calculate === 'function');
+Assert(typeof Quorum.calculateWide === 'function');
 Assert(typeof Quorum.update === 'function');
+Assert(typeof Quorum.updateMany === 'function');
+Assert(typeof Quorum.checksum === 'function');
 
 // Test method exceptions:
 [
@@ -414,8 +1177,8 @@ Assert(typeof Quorum.update === 'function');
   ],
   [
     'calculate',
-    new Array(11),
-    'arguments.length must be at most 10'
+    new Array(12),
+    'arguments.length must be at most 11'
   ],
   [
     'calculate',
@@ -514,96 +1277,394 @@ Assert(typeof Quorum.update === 'function');
   ],
   [
     'calculate',
-    Generate.argsOverride({ callback: {} }),
+    Generate.argsOverride({ options: 1 }),
+    'options must be an object'
+  ],
+  [
+    'calculate',
+    Generate.argsOverride({ options: {}, callback: {} }),
     'callback must be a function'
   ],
   [
     'calculate',
-    Generate.argsOverride({ sources: Generate.vectors([[2, 2]]) }), // Fast path
-    'vectors must not have cyclic references'
+    Generate.argsOverride({ options: { threads: 0 } }),
+    'options.threads must be at least 1'
+  ],
+  [
+    'calculate',
+    Generate.argsOverride({ options: { threads: Quorum.THREADS_MAX + 1 } }),
+    'options.threads must be at most THREADS_MAX'
+  ],
+  [
+    'calculate',
+    Generate.argsOverride({ options: { leaders: [] } }),
+    'options.leaders must be a Uint8Array'
+  ],
+  [
+    'calculate',
+    Generate.argsOverride({ options: { leaders: new Uint16Array(1) } }),
+    'options.leaders must be a Uint8Array'
   ],
   [
     'calculate',
     Generate.argsOverride({
-      sources: Generate.vectors([[4, 3], [3, 1], [1, 2], [2, 1]]), // Slow path
+      options: { leaders: new Uint8Array(1), leadersOffset: -1 }
     }),
-    'vectors must not have cyclic references'
+    'options.leadersOffset must be at least 0'
   ],
   [
     'calculate',
     Generate.argsOverride({
-      sources: Generate.vectors([[4, 3], [3, 1], [1, 1]]), // Slow path
+      options: { leaders: new Uint8Array(1), leadersOffset: 1 }
     }),
-    'vectors must not have cyclic references'
+    'options.leaders.length must be at least ' +
+    'options.leadersOffset + (sourceSize / objectSize)'
   ],
   [
-    'update',
-    [ new Uint8Array(Quorum.VECTOR), 0, Buffer.alloc(Quorum.ID, 1) ],
-    'vector must be a buffer' // We need buffer methods such as copy().
+    'calculate',
+    Generate.argsOverride({ options: { members: Buffer.alloc(1) } }),
+    'options.members.length must be at least ' +
+    'options.membersOffset + (sourceSize / objectSize * BITMAP)'
   ],
   [
-    'update',
-    [ Generate.vectors([[2, 1]])[0], -1.5, Buffer.alloc(Quorum.ID, 3) ],
-    'vectorOffset must be an integer'
+    'calculate',
+    Generate.argsOverride({
+      options: { lagging: Buffer.alloc(Quorum.BITMAP), laggingOffset: -1 }
+    }),
+    'options.laggingOffset must be at least 0'
   ],
   [
-    'update',
-    [ Generate.vectors([[2, 1]])[0], -1, Buffer.alloc(Quorum.ID, 3) ],
-    'vectorOffset must not be negative'
+    'calculate',
+    Generate.argsOverride({ options: { cache: Buffer.alloc(1) } }),
+    'options.cache.length must be at least ' +
+    'options.cacheOffset + (sourceSize / objectSize * CACHE)'
   ],
   [
-    'update',
-    [ Buffer.alloc(Quorum.VECTOR - 1), 0, Buffer.alloc(Quorum.ID, 3) ],
-    'vector.length must be at least ' + Quorum.VECTOR
+    'calculate',
+    Generate.argsOverride({
+      quorum: null,
+      options: { cache: Buffer.alloc(Quorum.SOURCES_MAX * 1024) }
+    }),
+    'options.cache requires a quorum buffer'
   ],
   [
-    'update',
-    [ Generate.vectors([[2, 1]])[0], 1, Buffer.alloc(Quorum.ID, 3) ],
-    'vectorOffset must not overflow'
+    'calculate',
+    Generate.argsOverride({ options: { changed: new Uint16Array(1024) } }),
+    'options.changed must be a Uint8Array'
   ],
   [
-    'update',
-    [ Generate.vectors([[0, 1]])[0], 0, Buffer.alloc(Quorum.ID, 2) ],
-    'vector[0] must not be zero'
+    'calculate',
+    Generate.argsOverride({
+      quorum: null,
+      options: { changed: new Uint8Array(Quorum.SOURCES_MAX * 1024) }
+    }),
+    'options.changed requires a quorum buffer'
   ],
   [
-    'update',
-    [ Generate.vectors([[1, 0]])[0], 0, Buffer.alloc(Quorum.ID, 2) ],
-    'vector[1] must not be zero'
+    'calculate',
+    Generate.argsOverride({ options: { chunk: 0 } }),
+    'options.chunk must be at least 1'
   ],
   [
-    'update',
-    [ Generate.vectors([[1, 1]])[0], 0, Buffer.alloc(Quorum.ID, 2) ],
-    'vector[0] must not equal vector[1]'
+    'calculate',
+    Generate.argsOverride({ options: { progress: {} } }),
+    'options.progress must be a function'
   ],
   [
-    'update',
-    [ Generate.vectors([[2, 1]])[0], 0, new Uint8Array(Quorum.ID) ],
-    'id must be a buffer'
+    'calculate',
+    Generate.argsOverride({ options: { signal: true } }),
+    'options.signal must be an object'
   ],
   [
-    'update',
-    [ Generate.vectors([[2, 1]])[0], 0, Buffer.alloc(Quorum.ID - 1, 3) ],
-    'id.length must be ' + Quorum.ID
+    'calculate',
+    Generate.argsOverride({ options: { stats: [] } }),
+    'options.stats must be a Float64Array'
   ],
   [
-    'update',
-    [ Generate.vectors([[2, 1]])[0], 0, Buffer.alloc(Quorum.ID + 1, 3) ],
-    'id.length must be ' + Quorum.ID
+    'calculate',
+    Generate.argsOverride({
+      options: { stats: new Float32Array(Quorum.STATS) }
+    }),
+    'options.stats must be a Float64Array'
   ],
   [
-    'update',
-    [ Generate.vectors([[2, 1]])[0], 0, Buffer.alloc(Quorum.ID, 0) ],
-    'id must not be zero'
+    'calculate',
+    Generate.argsOverride({
+      options: { stats: new Float64Array(Quorum.STATS - 1) }
+    }),
+    'options.stats.length must be at least STATS'
   ],
   [
-    'update',
-    [ Generate.vectors([[2, 1]])[0], 0, Buffer.alloc(Quorum.ID, 2) ],
-    'id must not equal vector[0]'
+    'calculate',
+    Generate.argsOverride({ sources: Generate.vectors([[2, 2]]) }), // Fast path
+    'vectors must not have cyclic references'
   ],
   [
-    'update',
-    [ Generate.vectors([[2, 1]])[0], 0, Buffer.alloc(Quorum.ID, 1) ],
+    'calculate',
+    Generate.argsOverride({
+      sources: Generate.vectors([[4, 3], [3, 1], [1, 2], [2, 1]]), // Slow path
+    }),
+    'vectors must not have cyclic references'
+  ],
+  [
+    'calculate',
+    Generate.argsOverride({
+      sources: Generate.vectors([[4, 3], [3, 1], [1, 1]]), // Slow path
+    }),
+    'vectors must not have cyclic references'
+  ],
+  [
+    'repair',
+    Generate.argsOverride({ sources: {} }),
+    'sources must be an array'
+  ],
+  [
+    'repair',
+    Generate.argsOverride({ options: { threads: 0 } }),
+    'options.threads must be at least 1'
+  ],
+  [
+    'repair',
+    Generate.argsOverride({ sources: Generate.vectors([[2, 2]]) }),
+    'vectors must not have cyclic references'
+  ],
+  [
+    'calculateBatch',
+    [ 0, Quorum.VECTOR, Generate.vectors([[1, 2]]), Buffer.alloc(0), null ],
+    'arguments.length must be at least 6'
+  ],
+  [
+    'calculateBatch',
+    [ 0, Quorum.VECTOR, Generate.vectors([[1, 2]]), {}, null, null ],
+    'extents must be a buffer'
+  ],
+  [
+    'calculateBatch',
+    [
+      0,
+      Quorum.VECTOR,
+      Generate.vectors([[1, 2]]),
+      Buffer.alloc(0),
+      null,
+      null
+    ],
+    'extents.length must be at least EXTENT'
+  ],
+  [
+    'calculateBatch',
+    [
+      0,
+      Quorum.VECTOR,
+      Generate.vectors([[1, 2]]),
+      Buffer.alloc(Quorum.EXTENT + 1),
+      null,
+      null
+    ],
+    'extents.length must be a multiple of EXTENT'
+  ],
+  [
+    'calculateBatch',
+    [
+      0,
+      Quorum.VECTOR,
+      Generate.vectors([[1, 2]]),
+      Generate.extents([[0, Quorum.VECTOR - 1, 0, 0]]),
+      null,
+      null
+    ],
+    'extent.sourceSize must be at least objectSize'
+  ],
+  [
+    'calculateBatch',
+    [
+      0,
+      Quorum.VECTOR,
+      Generate.vectors([[1, 2]]),
+      Generate.extents([[0, Quorum.VECTOR + 1, 0, 0]]),
+      null,
+      null
+    ],
+    'extent.sourceSize must be a multiple of objectSize'
+  ],
+  [
+    'calculateBatch',
+    [
+      0,
+      Quorum.VECTOR,
+      Generate.vectors([[1, 2]]),
+      Generate.extents([[1, Quorum.VECTOR, 0, 0]]),
+      null,
+      null
+    ],
+    'source.length must be at least extent.sourceOffset + extent.sourceSize'
+  ],
+  [
+    'calculateBatch',
+    [
+      0,
+      Quorum.VECTOR,
+      Generate.vectors([[1, 2]]),
+      Generate.extents([[0, Quorum.VECTOR, 1, 0]]),
+      Buffer.alloc(Quorum.SIZE),
+      null
+    ],
+    'quorum.length must be at least extent.quorumOffset + ' +
+    '(extent.sourceSize / objectSize * QUORUM_SIZE)'
+  ],
+  [
+    'calculateBatch',
+    [
+      0,
+      Quorum.VECTOR,
+      Generate.vectors([[1, 2]]),
+      Generate.extents([[0, Quorum.VECTOR, 0, Math.pow(2, 40)]]),
+      null,
+      Buffer.alloc(Quorum.VECTOR)
+    ],
+    'target.length must be at least extent.targetOffset + extent.sourceSize'
+  ],
+  [
+    'calculateBatch',
+    [
+      0,
+      Quorum.VECTOR,
+      Generate.vectors([[1, 2]]),
+      Generate.extents([[0, Quorum.VECTOR, 0, 0]]),
+      null,
+      null,
+      { threads: 0 }
+    ],
+    'options.threads must be at least 1'
+  ],
+  [
+    'update',
+    [ new Uint8Array(Quorum.VECTOR), 0, Buffer.alloc(Quorum.ID, 1) ],
+    'vector must be a buffer' // We need buffer methods such as copy().
+  ],
+  [
+    'update',
+    [ Generate.vectors([[2, 1]])[0], -1.5, Buffer.alloc(Quorum.ID, 3) ],
+    'vectorOffset must be an integer'
+  ],
+  [
+    'update',
+    [ Generate.vectors([[2, 1]])[0], -1, Buffer.alloc(Quorum.ID, 3) ],
+    'vectorOffset must not be negative'
+  ],
+  [
+    'update',
+    [ Buffer.alloc(Quorum.VECTOR - 1), 0, Buffer.alloc(Quorum.ID, 3) ],
+    'vector.length must be at least ' + Quorum.VECTOR
+  ],
+  [
+    'update',
+    [ Generate.vectors([[2, 1]])[0], 1, Buffer.alloc(Quorum.ID, 3) ],
+    'vectorOffset must not overflow'
+  ],
+  [
+    'update',
+    [ Generate.vectors([[0, 1]])[0], 0, Buffer.alloc(Quorum.ID, 2) ],
+    'vector[0] must not be zero'
+  ],
+  [
+    'update',
+    [ Generate.vectors([[1, 0]])[0], 0, Buffer.alloc(Quorum.ID, 2) ],
+    'vector[1] must not be zero'
+  ],
+  [
+    'update',
+    [ Generate.vectors([[1, 1]])[0], 0, Buffer.alloc(Quorum.ID, 2) ],
+    'vector[0] must not equal vector[1]'
+  ],
+  [
+    'update',
+    [ Generate.vectors([[2, 1]])[0], 0, new Uint8Array(Quorum.ID) ],
+    'id must be a buffer'
+  ],
+  [
+    'update',
+    [ Generate.vectors([[2, 1]])[0], 0, Buffer.alloc(Quorum.ID - 1, 3) ],
+    'id.length must be ' + Quorum.ID
+  ],
+  [
+    'update',
+    [ Generate.vectors([[2, 1]])[0], 0, Buffer.alloc(Quorum.ID + 1, 3) ],
+    'id.length must be ' + Quorum.ID
+  ],
+  [
+    'update',
+    [ Generate.vectors([[2, 1]])[0], 0, Buffer.alloc(Quorum.ID, 0) ],
+    'id must not be zero'
+  ],
+  [
+    'update',
+    [ Generate.vectors([[2, 1]])[0], 0, Buffer.alloc(Quorum.ID, 2) ],
+    'id must not equal vector[0]'
+  ],
+  [
+    'update',
+    [ Generate.vectors([[2, 1]])[0], 0, Buffer.alloc(Quorum.ID, 1) ],
+    'id must not equal vector[1]'
+  ],
+  [
+    'updateMany',
+    [ 0, Quorum.VECTOR, 0, Quorum.VECTOR, Generate.vectors([[2, 1]])[0] ],
+    'arguments.length must be at least 6'
+  ],
+  [
+    'updateMany',
+    new Array(7),
+    'arguments.length must be at most 6'
+  ],
+  [
+    'updateMany',
+    [ 1, Quorum.VECTOR, 0, Quorum.VECTOR, null, Buffer.alloc(Quorum.ID, 3) ],
+    'objectSize must be at least vectorOffset + VECTOR'
+  ],
+  [
+    'updateMany',
+    [ 0, Quorum.VECTOR, 0, Quorum.VECTOR + 1, null, null ],
+    'sourceSize must be a multiple of objectSize'
+  ],
+  [
+    'updateMany',
+    [ 0, Quorum.VECTOR, 0, Quorum.VECTOR, [], Buffer.alloc(Quorum.ID, 3) ],
+    'source must be a buffer'
+  ],
+  [
+    'updateMany',
+    [
+      0,
+      Quorum.VECTOR,
+      1,
+      Quorum.VECTOR,
+      Generate.vectors([[2, 1]])[0],
+      Buffer.alloc(Quorum.ID, 3)
+    ],
+    'source.length must be at least sourceOffset + sourceSize'
+  ],
+  [
+    'updateMany',
+    [
+      0,
+      Quorum.VECTOR,
+      0,
+      Quorum.VECTOR,
+      Generate.vectors([[2, 1]])[0],
+      Buffer.alloc(Quorum.ID * 2, 3)
+    ],
+    'ids.length must be ID or (sourceSize / objectSize * ID)'
+  ],
+  [
+    'updateMany',
+    [
+      0,
+      Quorum.VECTOR,
+      0,
+      Quorum.VECTOR,
+      Generate.vectors([[2, 1]])[0],
+      Buffer.alloc(Quorum.ID, 1)
+    ],
     'id must not equal vector[1]'
   ]
 ].forEach(
@@ -642,11 +1703,2053 @@ Assert(typeof Quorum.update === 'function');
   }
 })();
 
-// Test calculate():
-var queue = new Queue(8);
-queue.onData = function(test, end) {
-  var args = Generate.args();
-  function execute(...parameters) {
+// Test updateMany():
+(function() {
+  for (var test = 0; test < 100; test++) {
+    var objects = Generate.choose(1, 64);
+    var objectSize = Generate.choose(Quorum.VECTOR, 128);
+    var vectorOffset = Generate.choose(0, objectSize - Quorum.VECTOR);
+    var sourceOffset = Generate.choose(0, 64);
+    var sourceSize = objects * objectSize;
+    var source = RandomBuffer(sourceOffset + sourceSize + 64);
+    var ids = RandomBuffer(Random() < 0.5 ? Quorum.ID : objects * Quorum.ID);
+    var expect = Buffer.from(source);
+    for (var index = 0; index < objects; index++) {
+      Quorum.update(
+        expect,
+        sourceOffset + index * objectSize + vectorOffset,
+        ids.length === Quorum.ID ?
+          ids : ids.slice(index * Quorum.ID, (index + 1) * Quorum.ID)
+      );
+    }
+    var failed = Random() < 0.5 ? Generate.choose(0, objects - 1) : -1;
+    if (failed >= 0) {
+      // Break the vector of one object, which must update no objects at all:
+      var offset = sourceOffset + failed * objectSize + vectorOffset;
+      source.fill(0, offset, offset + Quorum.ID);
+      expect = Buffer.from(source);
+    }
+    try {
+      var error = undefined;
+      Quorum.updateMany(
+        vectorOffset,
+        objectSize,
+        sourceOffset,
+        sourceSize,
+        source,
+        ids
+      );
+    } catch (exception) {
+      error = exception;
+    }
+    if (failed >= 0) {
+      Assert(error.message === 'vector[0] must not be zero');
+      Assert(error.object === failed);
+    } else {
+      Assert(error === undefined);
+    }
+    Assert(source.equals(expect));
+  }
+})();
+
+// Test checksum():
+(function() {
+  // Bitwise CRC32C, for comparison with the table and hardware kernels:
+  function crc32c(buffer) {
+    var crc = 0xFFFFFFFF;
+    for (var index = 0; index < buffer.length; index++) {
+      crc ^= buffer[index];
+      for (var bit = 0; bit < 8; bit++) {
+        crc = (crc >>> 1) ^ (0x82F63B78 & -(crc & 1));
+      }
+    }
+    return (crc ^ 0xFFFFFFFF) >>> 0;
+  }
+  var check = Buffer.concat([Buffer.from('123456789'), Buffer.alloc(4)]);
+  Quorum.checksum(9, check.length, 0, check.length, check);
+  Assert(check.readUInt32LE(9) === 0xE3069283);
+  for (var test = 0; test < 100; test++) {
+    var objects = Generate.choose(1, 16);
+    var objectSize = Generate.choose(Quorum.CHECKSUM, 300);
+    var checksumOffset = Generate.choose(0, objectSize - Quorum.CHECKSUM);
+    var sourceOffset = Generate.choose(0, 64);
+    var sourceSize = objects * objectSize;
+    var source = RandomBuffer(sourceOffset + sourceSize + 64);
+    var expect = Buffer.from(source);
+    for (var object = 0; object < objects; object++) {
+      var offset = sourceOffset + object * objectSize;
+      var crc = crc32c(
+        Buffer.concat([
+          expect.slice(offset, offset + checksumOffset),
+          expect.slice(
+            offset + checksumOffset + Quorum.CHECKSUM,
+            offset + objectSize
+          )
+        ])
+      );
+      expect.writeUInt32LE(crc, offset + checksumOffset);
+    }
+    Assert(
+      Quorum.checksum(
+        checksumOffset,
+        objectSize,
+        sourceOffset,
+        sourceSize,
+        source
+      ) === source
+    );
+    Assert(source.equals(expect));
+  }
+})();
+
+// Test calculateWide():
+(function() {
+  function wide(quorum, offset) {
+    return [
+      quorum.readUInt16LE(offset + Quorum.WIDE_LEADER_OFFSET),
+      quorum.readUInt16LE(offset + Quorum.WIDE_LENGTH_OFFSET),
+      quorum.readUInt16LE(offset + Quorum.WIDE_REPAIR_OFFSET),
+      quorum[offset + Quorum.WIDE_FORKED_OFFSET]
+    ];
+  }
+  // The same results as calculate(), wherever calculate() can be used:
+  [1, 2, 3, 9, 17, Quorum.SOURCES_MAX].forEach(
+    function(sourcesLength) {
+      var objects = 32;
+      var objectSize = Quorum.VECTOR + 8;
+      var sourceSize = objects * objectSize;
+      var sources = Generate.sources(
+        4,
+        objectSize,
+        0,
+        sourceSize,
+        sourcesLength
+      );
+      var quorum = Buffer.alloc(objects * Quorum.SIZE);
+      var target = Buffer.alloc(sourceSize);
+      Quorum.calculate(
+        4,
+        objectSize,
+        0,
+        sourceSize,
+        sources,
+        quorum,
+        0,
+        target,
+        0
+      );
+      var quorumWide = Buffer.alloc(objects * Quorum.WIDE_SIZE);
+      var targetWide = Buffer.alloc(sourceSize);
+      Quorum.calculateWide(
+        4,
+        objectSize,
+        0,
+        sourceSize,
+        sources,
+        quorumWide,
+        0,
+        targetWide,
+        0
+      );
+      for (var object = 0; object < objects; object++) {
+        Assert.deepStrictEqual(
+          wide(quorumWide, object * Quorum.WIDE_SIZE),
+          Array.from(quorum.slice(object * Quorum.SIZE, (object + 1) * 4))
+        );
+      }
+      Assert(targetWide.equals(target));
+    }
+  );
+  // More replicas than calculate() allows, in every arrangement of chains:
+  var sourcesLength = 1000;
+  var objects = 6;
+  var ids = [];
+  for (var index = 0; index < 6; index++) ids.push(RandomBuffer(Quorum.ID));
+  var a = ids[0], b = ids[1], c = ids[2], x = ids[3], y = ids[4], z = ids[5];
+  var arrangements = [
+    function(index) { return [b, a]; }, // All agree.
+    function(index) { return index < 600 ? [c, b] : [b, a]; }, // 400 lag.
+    function(index) { return index % 2 ? [c, b] : [y, x]; }, // Forked.
+    function(index) { return [[c, b], [b, a], [y, x]][index % 3]; },
+    function(index) { return index === 999 ? [z, y] : [b, a]; },
+    function(index) { return [[y, x], [z, y], [c, b], [b, a]][index % 4]; }
+  ];
+  var sources = [];
+  for (var index = 0; index < sourcesLength; index++) {
+    var source = Buffer.alloc(objects * Quorum.VECTOR);
+    arrangements.forEach(
+      function(arrangement, object) {
+        var vector = arrangement(index);
+        vector[0].copy(source, object * Quorum.VECTOR);
+        vector[1].copy(source, object * Quorum.VECTOR + Quorum.ID);
+      }
+    );
+    sources.push(source);
+  }
+  function verify(quorum) {
+    for (var object = 0; object < objects; object++) {
+      var reference = [];
+      Reference.calculateObject(sources, object * Quorum.VECTOR, reference, 0);
+      Assert.deepStrictEqual(
+        wide(quorum, object * Quorum.WIDE_SIZE),
+        reference
+      );
+    }
+  }
+  var sourceSize = objects * Quorum.VECTOR;
+  var quorum = Buffer.alloc(objects * Quorum.WIDE_SIZE);
+  Quorum.calculateWide(
+    0,
+    Quorum.VECTOR,
+    0,
+    sourceSize,
+    sources,
+    quorum,
+    0,
+    null,
+    0
+  );
+  verify(quorum);
+  Assert.deepStrictEqual(wide(quorum, Quorum.WIDE_SIZE), [0, 1000, 400, 0]);
+  // A cyclic reference fails the calculation:
+  var cyclic = sources.slice(0, 500).map(
+    function(source) {
+      return source.slice(0, Quorum.VECTOR);
+    }
+  );
+  cyclic.push(Buffer.concat([a, a]));
+  Assert.throws(
+    function() {
+      Quorum.calculateWide(0, Quorum.VECTOR, 0, 32, cyclic, null, 0, null, 0);
+    },
+    /vectors must not have cyclic references/
+  );
+  // Options which assume at most SOURCES_MAX replicas are not supported:
+  Assert.throws(
+    function() {
+      Quorum.calculateWide(
+        0,
+        Quorum.VECTOR,
+        0,
+        sourceSize,
+        sources,
+        quorum,
+        0,
+        null,
+        0,
+        { leaders: Buffer.alloc(objects) }
+      );
+    },
+    /calculateWide\(\) supports only threads, chunk, progress and signal/
+  );
+  // calculate() is still limited to SOURCES_MAX replicas:
+  Assert.throws(
+    function() {
+      Quorum.calculate(
+        0,
+        Quorum.VECTOR,
+        0,
+        sourceSize,
+        sources,
+        null,
+        0,
+        null,
+        0
+      );
+    },
+    /sources.length must be at most SOURCES_MAX/
+  );
+  var quorumAsync = Buffer.alloc(objects * Quorum.WIDE_SIZE);
+  Quorum.calculateWide(
+    0,
+    Quorum.VECTOR,
+    0,
+    sourceSize,
+    sources,
+    quorumAsync,
+    0,
+    null,
+    0,
+    { threads: 2, chunk: 4 },
+    function(error) {
+      if (error) throw error;
+      verify(quorumAsync);
+    }
+  );
+})();
+
+// Test calculate() with a long chain of lagging replicas:
+(function() {
+  var vectors = [];
+  for (var id = 1; id < Quorum.SOURCES_MAX; id++) vectors.push([id + 1, id]);
+  Generate.shuffle(vectors);
+  var sources = Generate.vectors(vectors);
+  var quorum = Buffer.alloc(Quorum.SIZE);
+  var target = Buffer.alloc(Quorum.VECTOR);
+  Quorum.calculate(
+    0,
+    Quorum.VECTOR,
+    0,
+    Quorum.VECTOR,
+    sources,
+    quorum,
+    0,
+    target,
+    0
+  );
+  var leader = sources.findIndex(
+    function(source) {
+      return source[0] === Quorum.SOURCES_MAX;
+    }
+  );
+  Assert(quorum[Quorum.LEADER_OFFSET] === leader);
+  Assert(quorum[Quorum.LENGTH_OFFSET] === Quorum.SOURCES_MAX - 1);
+  Assert(quorum[Quorum.REPAIR_OFFSET] === Quorum.SOURCES_MAX - 2);
+  Assert(quorum[Quorum.FORKED_OFFSET] === 0);
+  Assert(target.equals(sources[leader]));
+})();
+
+// Test calculate() with the kernels specialized for a few replicas:
+(function() {
+  for (var length = 1; length <= 9; length++) {
+    [
+      [2, 1], // All replicas agree.
+      [1, 1], // All replicas agree, on a cyclic vector.
+      [2, 3], // Same leading ID, different dependency.
+      [3, 2], // One replica leads the others.
+      [4, 5] // One replica is unrelated to the others.
+    ].forEach(
+      function(vector) {
+        var vectors = [];
+        for (var index = 0; index < length; index++) {
+          vectors.push(index === length - 1 ? vector : [2, 1]);
+        }
+        var sources = Generate.vectors(vectors);
+        var quorum = Buffer.alloc(Quorum.SIZE);
+        var quorumReference = Buffer.alloc(Quorum.SIZE);
+        try {
+          var error = undefined;
+          Quorum.calculate(0, 32, 0, 32, sources, quorum, 0, null, 0);
+        } catch (exception) {
+          error = exception;
+        }
+        if (vector[0] === vector[1]) {
+          Assert(error && error.code === 'ERR_CYCLIC_REFERENCES');
+        } else {
+          Assert(error === undefined);
+          Reference.calculateObject(sources, 0, quorumReference, 0);
+          Assert(quorum.equals(quorumReference));
+        }
+      }
+    );
+  }
+})();
+
+// Test calculate() across threads:
+(function() {
+  var objects = 8192 + 3;
+  var objectSize = Quorum.VECTOR + 8;
+  var vectorOffset = 4;
+  var sourceSize = objects * objectSize;
+  var sources = Generate.sources(vectorOffset, objectSize, 0, sourceSize, 5);
+  function calculate(threads, stream) {
+    var quorum = Buffer.alloc(objects * Quorum.SIZE);
+    var target = Buffer.alloc(sourceSize);
+    Quorum.calculate(
+      vectorOffset,
+      objectSize,
+      0,
+      sourceSize,
+      sources,
+      quorum,
+      0,
+      target,
+      0,
+      { threads: threads, stream: stream }
+    );
+    return Buffer.concat([quorum, target]);
+  }
+  var expect = calculate(1, false);
+  Assert(calculate(4, false).equals(expect));
+  Assert(calculate(Quorum.THREADS_MAX, false).equals(expect));
+  Assert(calculate(1, true).equals(expect));
+  Assert(calculate(4, true).equals(expect));
+  // A cyclic reference in any range must fail the whole calculation:
+  var offset = (objects - 2) * objectSize + vectorOffset;
+  sources[0].copy(sources[0], offset + Quorum.ID, offset, offset + Quorum.ID);
+  try {
+    calculate(4);
+  } catch (exception) {
+    var error = exception;
+  }
+  Assert(error && error.code === 'ERR_CYCLIC_REFERENCES');
+})();
+
+// Test calculate() asynchronously in chunks:
+(function() {
+  var objects = 10000 + 3;
+  var objectSize = Quorum.VECTOR + 8;
+  var vectorOffset = 4;
+  var sourceSize = objects * objectSize;
+  var sources = Generate.sources(vectorOffset, objectSize, 0, sourceSize, 5);
+  var quorumExpect = Buffer.alloc(objects * Quorum.SIZE);
+  var targetExpect = Buffer.alloc(sourceSize);
+  Quorum.calculate(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    sources,
+    quorumExpect,
+    0,
+    targetExpect,
+    0
+  );
+  function calculate(options, end) {
+    var quorum = Buffer.alloc(objects * Quorum.SIZE);
+    var target = Buffer.alloc(sourceSize);
+    var progress = [];
+    options.progress = function(processed, total) {
+      Assert(total === objects);
+      progress.push(processed);
+      if (options.abort && processed >= options.abort) {
+        options.signal.aborted = true;
+      }
+    };
+    Quorum.calculate(
+      vectorOffset,
+      objectSize,
+      0,
+      sourceSize,
+      sources,
+      quorum,
+      0,
+      target,
+      0,
+      options,
+      function(error) {
+        end(error, quorum, target, progress);
+      }
+    );
+  }
+  calculate(
+    { chunk: 1024, threads: 2 },
+    function(error, quorum, target, progress) {
+      if (error) throw error;
+      Assert(quorum.equals(quorumExpect));
+      Assert(target.equals(targetExpect));
+      var expect = [];
+      for (var end = 1024; end < objects; end += 1024) expect.push(end);
+      expect.push(objects);
+      Assert.deepStrictEqual(progress, expect);
+    }
+  );
+  // Objects calculated before an abort remain valid:
+  calculate(
+    { chunk: 3000, signal: { aborted: false }, abort: 6000 },
+    function(error, quorum, target, progress) {
+      Assert(error && error.code === 'ABORT_ERR');
+      Assert.deepStrictEqual(progress, [3000, 6000]);
+      var quorumSize = 6000 * Quorum.SIZE;
+      Assert(quorum.slice(0, quorumSize).equals(
+        quorumExpect.slice(0, quorumSize)
+      ));
+      Assert(quorum.slice(quorumSize).equals(
+        Buffer.alloc(quorum.length - quorumSize)
+      ));
+      Assert(target.slice(0, 6000 * objectSize).equals(
+        targetExpect.slice(0, 6000 * objectSize)
+      ));
+    }
+  );
+  var controller = new AbortController();
+  calculate(
+    { chunk: 4096, signal: controller.signal },
+    function(error) {
+      Assert(error && error.code === 'ABORT_ERR');
+    }
+  );
+  controller.abort();
+  // An exception thrown by progress is passed to the callback:
+  Quorum.calculate(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    sources,
+    null,
+    0,
+    null,
+    0,
+    {
+      chunk: 4096,
+      progress: function() {
+        throw new Error('progress');
+      }
+    },
+    function(error) {
+      Assert(error && error.message === 'progress');
+    }
+  );
+})();
+
+// Test promises.calculate() and chunks():
+(function() {
+  var objects = 5000 + 1;
+  var objectSize = Quorum.VECTOR;
+  var sourceSize = objects * objectSize;
+  var sources = Generate.sources(0, objectSize, 0, sourceSize, 3);
+  var quorumExpect = Buffer.alloc(objects * Quorum.SIZE);
+  var targetExpect = Buffer.alloc(sourceSize);
+  Quorum.calculate(
+    0,
+    objectSize,
+    0,
+    sourceSize,
+    sources,
+    quorumExpect,
+    0,
+    targetExpect,
+    0
+  );
+  function args(options) {
+    return [0, objectSize, 0, sourceSize, sources, options];
+  }
+  Quorum.promises.calculate(...args()).then(
+    function(result) {
+      Assert(result.quorum.equals(quorumExpect));
+      Assert(result.target.equals(targetExpect));
+    }
+  );
+  Quorum.promises.calculate(...args({ target: false, threads: 2 })).then(
+    function(result) {
+      Assert(result.quorum.equals(quorumExpect));
+      Assert(result.target === null);
+    }
+  );
+  Quorum.promises.calculate(0, objectSize, 0, sourceSize + 1, sources).then(
+    function() {
+      throw new Error('expected an exception');
+    },
+    function(error) {
+      Assert(error.message === 'sourceSize must be a multiple of objectSize');
+    }
+  );
+  // A region beyond the sources is refused by the native method, before any
+  // buffer is allocated for it:
+  Quorum.promises.calculate(0, 32, 0, Math.pow(2, 33), [Buffer.alloc(64)]).then(
+    function() {
+      throw new Error('expected an exception');
+    },
+    function(error) {
+      Assert(
+        error.message ===
+        'source.length must be at least sourceOffset + sourceSize'
+      );
+    }
+  );
+  (async function() {
+    var chunks = [];
+    var begin = 0;
+    var progress = 0;
+    var iterator = Quorum.chunks(
+      ...args({ chunk: 1000, progress: function() { progress++; } })
+    );
+    for await (var chunk of iterator) {
+      Assert(chunk.begin === begin);
+      begin = chunk.end;
+      Assert(chunk.quorum.equals(
+        quorumExpect.slice(chunk.begin * Quorum.SIZE, chunk.end * Quorum.SIZE)
+      ));
+      Assert(chunk.target.equals(
+        targetExpect.slice(chunk.begin * objectSize, chunk.end * objectSize)
+      ));
+      chunks.push(chunk);
+    }
+    Assert(chunks.length === 6);
+    Assert(chunks[5].end === objects);
+    Assert(progress === 6);
+    // Stopping early aborts the remaining chunks:
+    var count = 0;
+    for await (var chunk of Quorum.chunks(...args({ chunk: 1000 }))) {
+      if (++count === 2) break;
+    }
+    // Errors are thrown by the iterator:
+    var cyclic = Generate.vectors([[1, 1]]);
+    try {
+      for await (var chunk of Quorum.chunks(0, 32, 0, 32, cyclic)) {}
+    } catch (exception) {
+      var error = exception;
+    }
+    Assert(error && error.code === 'ERR_CYCLIC_REFERENCES');
+  })().catch(
+    function(error) {
+      console.error(error);
+      process.exit(1);
+    }
+  );
+})();
+
+// Test calculate() with only leaders:
+(function() {
+  var objects = 64;
+  var objectSize = Quorum.VECTOR;
+  var sourceSize = objects * objectSize;
+  var sources = Generate.sources(0, objectSize, 0, sourceSize, 7);
+  var quorum = Buffer.alloc(objects * Quorum.SIZE);
+  var target = Buffer.alloc(sourceSize);
+  Quorum.calculate(0, objectSize, 0, sourceSize, sources, quorum, 0, target, 0);
+  var quorumNull = Buffer.alloc(objects * Quorum.SIZE);
+  var leaders = new Uint8Array(objects + 2);
+  Quorum.calculate(
+    0,
+    objectSize,
+    0,
+    sourceSize,
+    sources,
+    quorumNull,
+    0,
+    null,
+    0,
+    { leaders: leaders, leadersOffset: 2 }
+  );
+  Assert(quorumNull.equals(quorum));
+  for (var index = 0; index < objects; index++) {
+    var offset = index * Quorum.SIZE;
+    if (quorum[offset + Quorum.LENGTH_OFFSET] === 0) {
+      Assert(leaders[2 + index] === Quorum.LEADER_NONE);
+    } else {
+      Assert(leaders[2 + index] === quorum[offset + Quorum.LEADER_OFFSET]);
+    }
+  }
+  var leadersOnly = Buffer.alloc(objects);
+  Quorum.calculate(
+    0,
+    objectSize,
+    0,
+    sourceSize,
+    sources,
+    null,
+    0,
+    null,
+    0,
+    { leaders: leadersOnly }
+  );
+  Assert(leadersOnly.equals(leaders.subarray(2)));
+})();
+
+// Test calculate() with options.cache:
+(function() {
+  var objects = 512;
+  var objectSize = Quorum.VECTOR + 8;
+  var vectorOffset = 4;
+  var sourceSize = objects * objectSize;
+  var sources = Generate.sources(vectorOffset, objectSize, 0, sourceSize, 7);
+  var cache = Buffer.alloc(objects * Quorum.CACHE);
+  var quorum = Buffer.alloc(objects * Quorum.SIZE);
+  var members = Buffer.alloc(objects * Quorum.BITMAP);
+  function expect() {
+    var quorum = Buffer.alloc(objects * Quorum.SIZE);
+    var members = Buffer.alloc(objects * Quorum.BITMAP);
+    Quorum.calculate(
+      vectorOffset,
+      objectSize,
+      0,
+      sourceSize,
+      sources,
+      quorum,
+      0,
+      null,
+      0,
+      { members: members }
+    );
+    return { quorum: quorum, members: members };
+  }
+  function calculate(threads) {
+    var previous = Buffer.from(quorum);
+    var changed = Buffer.alloc(objects, 255);
+    Quorum.calculate(
+      vectorOffset,
+      objectSize,
+      0,
+      sourceSize,
+      sources,
+      quorum,
+      0,
+      null,
+      0,
+      { threads: threads, cache: cache, changed: changed, members: members }
+    );
+    var result = expect();
+    Assert(quorum.equals(result.quorum));
+    Assert(members.equals(result.members));
+    for (var index = 0; index < objects; index++) {
+      var offset = index * Quorum.SIZE;
+      var different = previous.compare(
+        quorum,
+        offset,
+        offset + Quorum.SIZE,
+        offset,
+        offset + Quorum.SIZE
+      ) !== 0;
+      Assert(changed[index] === (different ? 1 : 0));
+    }
+    return changed;
+  }
+  // Every object is calculated the first time:
+  calculate(1);
+  for (var index = 0; index < objects; index++) {
+    Assert(cache.readUInt32LE(index * Quorum.CACHE) !== 0);
+  }
+  // Unchanged objects keep their previous results without being calculated:
+  Assert(calculate(2).every(function(changed) { return changed === 0; }));
+  quorum.fill(255, 0, Quorum.SIZE);
+  Quorum.calculate(
+    vectorOffset,
+    objectSize,
+    0,
+    objectSize,
+    sources,
+    quorum,
+    0,
+    null,
+    0,
+    { cache: cache }
+  );
+  Assert(quorum.readUInt32LE(0) === 0xFFFFFFFF);
+  // Objects whose vectors change are calculated again:
+  for (var index = 0; index < 4; index++) {
+    Generate.update([sources[index]], index * objectSize + vectorOffset);
+  }
+  var changed = calculate(1);
+  Assert(changed[0] === 1);
+  for (var index = 4; index < objects; index++) Assert(changed[index] === 0);
+  // A repaired object is calculated again next time:
+  var repaired = Quorum.repair(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    sources,
+    quorum,
+    0,
+    null,
+    0,
+    { cache: cache }
+  );
+  for (var index = 0; index < objects; index++) {
+    var entry = cache.slice(index * Quorum.CACHE, (index + 1) * Quorum.CACHE);
+    Assert(entry.equals(Buffer.alloc(Quorum.CACHE)) === (repaired[index] > 0));
+  }
+  calculate(1);
+})();
+
+// Test calculate() with options.sparse:
+(function() {
+  var objects = 8192 + 3;
+  var objectSize = Quorum.VECTOR;
+  var sourceSize = objects * objectSize;
+  var sourcesLength = 5;
+  var sources = Generate.sources(0, objectSize, 0, sourceSize, sourcesLength);
+  var quorum = Buffer.alloc(objects * Quorum.SIZE);
+  Quorum.calculate(0, objectSize, 0, sourceSize, sources, quorum, 0, null, 0);
+  // Every object which is lagging, forked or short of unanimity, in order:
+  var expected = [];
+  for (var object = 0; object < objects; object++) {
+    var offset = object * Quorum.SIZE;
+    if (
+      quorum[offset + Quorum.LENGTH_OFFSET] === sourcesLength &&
+      quorum[offset + Quorum.REPAIR_OFFSET] === 0
+    ) {
+      continue;
+    }
+    var entry = Buffer.alloc(Quorum.SPARSE);
+    entry.writeUInt32LE(object, 0);
+    quorum.copy(entry, 4, offset, offset + Quorum.SIZE);
+    expected.push(entry);
+  }
+  Assert(expected.length > 0);
+  Assert(expected.length < objects);
+  function calculate(capacity, options) {
+    var sparse = Buffer.alloc(capacity * Quorum.SPARSE);
+    var length = Quorum.calculate(
+      0,
+      objectSize,
+      0,
+      sourceSize,
+      sources,
+      null,
+      0,
+      null,
+      0,
+      Object.assign({ sparse: sparse }, options)
+    );
+    verify(capacity, sparse, length);
+  }
+  function verify(capacity, sparse, length) {
+    Assert(length === expected.length);
+    var kept = Math.min(capacity, expected.length);
+    Assert(
+      sparse.slice(0, kept * Quorum.SPARSE).equals(
+        Buffer.concat(expected.slice(0, kept))
+      )
+    );
+    var rest = sparse.slice(kept * Quorum.SPARSE);
+    Assert(rest.equals(Buffer.alloc(rest.length)));
+  }
+  // The capacity of options.sparse caps the entries, but not the count, and
+  // the entries kept are those of the first objects, across threads:
+  [1, 7, expected.length, objects].forEach(
+    function(capacity) {
+      calculate(capacity, {});
+      calculate(capacity, { threads: 4 });
+    }
+  );
+  // Healthy objects produce no entries:
+  var healthy = Generate.sources(0, objectSize, 0, objectSize, 3);
+  healthy = healthy.map(
+    function() {
+      return healthy[0];
+    }
+  );
+  var length = Quorum.calculate(
+    0,
+    objectSize,
+    0,
+    objectSize,
+    healthy,
+    null,
+    0,
+    null,
+    0,
+    { sparse: Buffer.alloc(Quorum.SPARSE) }
+  );
+  Assert(length === 0);
+  Assert.throws(
+    function() {
+      Quorum.repair(
+        0,
+        objectSize,
+        0,
+        sourceSize,
+        sources,
+        null,
+        0,
+        null,
+        0,
+        { sparse: Buffer.alloc(Quorum.SPARSE) }
+      );
+    },
+    /options.sparse is not supported by repair\(\)/
+  );
+  // Entries continue across the chunks of an asynchronous calculation:
+  var sparseAsync = Buffer.alloc(16 * Quorum.SPARSE);
+  Quorum.calculate(
+    0,
+    objectSize,
+    0,
+    sourceSize,
+    sources,
+    null,
+    0,
+    null,
+    0,
+    { sparse: sparseAsync, chunk: 1000 },
+    function(error, length) {
+      if (error) throw error;
+      verify(16, sparseAsync, length);
+    }
+  );
+})();
+
+// Test calculate() and repair() with options.checksum:
+(function() {
+  var objects = 4096 + 5;
+  var vectorOffset = 4;
+  var objectSize = vectorOffset + Quorum.VECTOR + 28;
+  var checksumOffset = objectSize - Quorum.CHECKSUM;
+  var sourceSize = objects * objectSize;
+  var sourcesLength = 5;
+  var sources = Generate.sources(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    sourcesLength
+  );
+  sources.forEach(
+    function(source) {
+      Quorum.checksum(checksumOffset, objectSize, 0, sourceSize, source);
+    }
+  );
+  // Corrupt a byte of the payload, vector or checksum of some replicas:
+  var corrupt = [];
+  for (var object = 0; object < objects; object++) {
+    var indices = [];
+    var count = Random() < 0.5 ? 0 : Generate.choose(1, sourcesLength);
+    while (indices.length < count) {
+      var index = Generate.choose(0, sourcesLength - 1);
+      if (indices.indexOf(index) !== -1) continue;
+      indices.push(index);
+      var offset = object * objectSize + Generate.choose(0, objectSize - 1);
+      sources[index][offset] ^= 1 << Generate.choose(0, 7);
+    }
+    corrupt.push(indices);
+  }
+  // The quorum of each object is that of its verified replicas alone:
+  var expectQuorum = Buffer.alloc(objects * Quorum.SIZE);
+  var expectMembers = Buffer.alloc(objects * Quorum.BITMAP);
+  for (var object = 0; object < objects; object++) {
+    var verified = [];
+    for (var index = 0; index < sourcesLength; index++) {
+      if (corrupt[object].indexOf(index) === -1) verified.push(index);
+    }
+    if (verified.length === 0) continue;
+    var quorum = Buffer.alloc(Quorum.SIZE);
+    var members = Buffer.alloc(Quorum.BITMAP);
+    Quorum.calculate(
+      vectorOffset,
+      objectSize,
+      object * objectSize,
+      objectSize,
+      verified.map(
+        function(index) {
+          return sources[index];
+        }
+      ),
+      quorum,
+      0,
+      null,
+      0,
+      { members: members }
+    );
+    if (quorum[Quorum.LENGTH_OFFSET] > 0) {
+      quorum[Quorum.LEADER_OFFSET] = verified[quorum[Quorum.LEADER_OFFSET]];
+    }
+    quorum.copy(expectQuorum, object * Quorum.SIZE);
+    verified.forEach(
+      function(index, position) {
+        if (members[position >> 3] & (1 << (position & 7))) {
+          expectMembers[object * Quorum.BITMAP + (index >> 3)] |= (
+            1 << (index & 7)
+          );
+        }
+      }
+    );
+  }
+  function calculate(options) {
+    var quorum = Buffer.alloc(objects * Quorum.SIZE);
+    var members = Buffer.alloc(objects * Quorum.BITMAP);
+    var rejected = Buffer.alloc(objects);
+    Quorum.calculate(
+      vectorOffset,
+      objectSize,
+      0,
+      sourceSize,
+      sources,
+      quorum,
+      0,
+      null,
+      0,
+      Object.assign(
+        { checksum: checksumOffset, rejected: rejected, members: members },
+        options
+      )
+    );
+    verify(quorum, members, rejected);
+  }
+  function verify(quorum, members, rejected) {
+    Assert(quorum.equals(expectQuorum));
+    Assert(members.equals(expectMembers));
+    for (var object = 0; object < objects; object++) {
+      Assert(rejected[object] === corrupt[object].length);
+    }
+  }
+  calculate({});
+  calculate({ threads: 4 });
+  calculate({ stream: true });
+  // Without options.checksum, corrupt replicas still count:
+  var rejected = Buffer.alloc(objects);
+  Assert.throws(
+    function() {
+      Quorum.calculate(
+        vectorOffset,
+        objectSize,
+        0,
+        sourceSize,
+        sources,
+        null,
+        0,
+        null,
+        0,
+        { rejected: rejected }
+      );
+    },
+    /options.rejected requires options.checksum/
+  );
+  [
+    [{ checksum: vectorOffset }, /must not overlap the vector/],
+    [{ checksum: objectSize - 3 }, /options.checksum must be at most/],
+    [
+      { checksum: checksumOffset, cache: Buffer.alloc(objects * Quorum.CACHE) },
+      /options.checksum is not supported with options.cache/
+    ]
+  ].forEach(
+    function(test) {
+      Assert.throws(
+        function() {
+          Quorum.calculate(
+            vectorOffset,
+            objectSize,
+            0,
+            sourceSize,
+            sources,
+            Buffer.alloc(objects * Quorum.SIZE),
+            0,
+            null,
+            0,
+            test[0]
+          );
+        },
+        test[1]
+      );
+    }
+  );
+  Assert.throws(
+    function() {
+      Quorum.calculateWide(
+        vectorOffset,
+        objectSize,
+        0,
+        sourceSize,
+        sources,
+        null,
+        0,
+        null,
+        0,
+        { checksum: checksumOffset }
+      );
+    },
+    /calculateWide\(\) supports only/
+  );
+  // Asynchronously, in chunks:
+  var quorumAsync = Buffer.alloc(objects * Quorum.SIZE);
+  var membersAsync = Buffer.alloc(objects * Quorum.BITMAP);
+  var rejectedAsync = Buffer.alloc(objects);
+  Quorum.calculate(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    sources.map(
+      function(source) {
+        return Buffer.from(source);
+      }
+    ),
+    quorumAsync,
+    0,
+    null,
+    0,
+    {
+      checksum: checksumOffset,
+      rejected: rejectedAsync,
+      members: membersAsync,
+      chunk: 1000
+    },
+    function(error) {
+      if (error) throw error;
+      verify(quorumAsync, membersAsync, rejectedAsync);
+    }
+  );
+  // Repair rewrites corrupt replicas, even those with the leader's vector,
+  // and leaves every replica of an object with a quorum verified:
+  var copies = sources.map(
+    function(source) {
+      return Buffer.from(source);
+    }
+  );
+  var repaired = Quorum.repair(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    copies,
+    null,
+    0,
+    null,
+    0,
+    { checksum: checksumOffset }
+  );
+  var quorum = Buffer.alloc(objects * Quorum.SIZE);
+  var rejected = Buffer.alloc(objects);
+  Quorum.calculate(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    copies,
+    quorum,
+    0,
+    null,
+    0,
+    { checksum: checksumOffset, rejected: rejected }
+  );
+  for (var object = 0; object < objects; object++) {
+    var length = expectQuorum[object * Quorum.SIZE + Quorum.LENGTH_OFFSET];
+    if (length === 0) {
+      Assert(repaired[object] === 0);
+      Assert(rejected[object] === corrupt[object].length);
+    } else {
+      Assert(repaired[object] >= corrupt[object].length);
+      Assert(rejected[object] === 0);
+      Assert(
+        quorum[object * Quorum.SIZE + Quorum.LENGTH_OFFSET] === sourcesLength
+      );
+    }
+  }
+})();
+
+// Test calculate() with options.stats:
+(function() {
+  function stats(vectors, options) {
+    options = options || {};
+    options.stats = options.stats || new Float64Array(Quorum.STATS);
+    var quorum = Buffer.alloc(Quorum.SIZE);
+    Quorum.calculate(0, 32, 0, 32, vectors, quorum, 0, null, 0, options);
+    return options.stats;
+  }
+  // Each path is counted:
+  var fast = stats(Generate.vectors([[2, 1], [2, 1], [3, 1]]));
+  Assert(fast[Quorum.STATS_FAST] === 1);
+  Assert(fast[Quorum.STATS_ORDERED] === 0);
+  Assert(fast[Quorum.STATS_LENGTH + 2] === 1);
+  Assert(fast[Quorum.STATS_FAST_NS] >= 0);
+  Assert(fast[Quorum.STATS_SLOW_NS] === 0);
+  var ordered = stats(Generate.vectors([[3, 2], [2, 1], [2, 1]]));
+  Assert(ordered[Quorum.STATS_ORDERED] === 1);
+  Assert(ordered[Quorum.STATS_LENGTH + 3] === 1);
+  Assert(ordered[Quorum.STATS_REPAIR + 2] === 1);
+  var chains = stats(Generate.vectors([[2, 1], [3, 1], [4, 1]]));
+  Assert(chains[Quorum.STATS_CHAINS] === 1);
+  Assert(chains[Quorum.STATS_FORKED] === 1);
+  Assert(chains[Quorum.STATS_LENGTH + 0] === 1);
+  try {
+    var cyclic = new Float64Array(Quorum.STATS);
+    stats(Generate.vectors([[2, 1], [1, 1]]), { stats: cyclic });
+  } catch (exception) {
+    var error = exception;
+  }
+  Assert(error && error.code === 'ERR_CYCLIC_REFERENCES');
+  Assert(cyclic[Quorum.STATS_CYCLIC] === 1);
+  // Counters are added to across calls and threads:
+  var objects = 4096 + 7;
+  var objectSize = Quorum.VECTOR;
+  var sourceSize = objects * objectSize;
+  var sources = Generate.sources(0, objectSize, 0, sourceSize, 5);
+  var quorum = Buffer.alloc(objects * Quorum.SIZE);
+  var cache = Buffer.alloc(objects * Quorum.CACHE);
+  var result = new Float64Array(Quorum.STATS);
+  [1, 4].forEach(
+    function(threads) {
+      Quorum.calculate(
+        0,
+        objectSize,
+        0,
+        sourceSize,
+        sources,
+        quorum,
+        0,
+        null,
+        0,
+        { threads: threads, cache: cache, stats: result }
+      );
+    }
+  );
+  var expect = new Float64Array(Quorum.STATS);
+  for (var index = 0; index < objects; index++) {
+    var offset = index * Quorum.SIZE;
+    if (quorum[offset + Quorum.FORKED_OFFSET]) expect[Quorum.STATS_FORKED]++;
+    expect[Quorum.STATS_LENGTH + quorum[offset + Quorum.LENGTH_OFFSET]]++;
+    expect[Quorum.STATS_REPAIR + quorum[offset + Quorum.REPAIR_OFFSET]]++;
+  }
+  Assert(result[Quorum.STATS_FORKED] === expect[Quorum.STATS_FORKED] * 2);
+  for (var index = 0; index < 256; index++) {
+    var length = Quorum.STATS_LENGTH + index;
+    var repair = Quorum.STATS_REPAIR + index;
+    Assert(result[length] === expect[length] * 2);
+    Assert(result[repair] === expect[repair] * 2);
+  }
+  Assert(
+    result[Quorum.STATS_FAST] +
+    result[Quorum.STATS_ORDERED] +
+    result[Quorum.STATS_CHAINS] === objects
+  );
+  Assert(result[Quorum.STATS_ORDERED] > 0);
+  Assert(result[Quorum.STATS_CACHED] === objects);
+  Assert(result[Quorum.STATS_CYCLIC] === 0);
+})();
+
+// Test repair():
+(function() {
+  var objects = 256;
+  var objectSize = Quorum.VECTOR + 8;
+  var vectorOffset = 4;
+  var sourceSize = objects * objectSize;
+  var sources = Generate.sources(vectorOffset, objectSize, 0, sourceSize, 9);
+  // Give each replica's object a different payload around the vector:
+  sources.forEach(
+    function(source, index) {
+      for (var object = 0; object < objects; object++) {
+        var offset = object * objectSize;
+        source.fill(index, offset, offset + vectorOffset);
+        source.fill(
+          index,
+          offset + vectorOffset + Quorum.VECTOR,
+          offset + objectSize
+        );
+      }
+    }
+  );
+  var quorum = Buffer.alloc(objects * Quorum.SIZE);
+  var target = Buffer.alloc(sourceSize);
+  Quorum.calculate(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    sources,
+    quorum,
+    0,
+    target,
+    0
+  );
+  function verify(copies, quorumRepair, targetRepair, repaired) {
+    Assert(quorumRepair.equals(quorum));
+    Assert(targetRepair.equals(target));
+    Assert(repaired.length === objects);
+    for (var object = 0; object < objects; object++) {
+      var offset = object * objectSize;
+      var end = offset + objectSize;
+      var length = quorum[object * Quorum.SIZE + Quorum.LENGTH_OFFSET];
+      var leader = quorum[object * Quorum.SIZE + Quorum.LEADER_OFFSET];
+      var expect = 0;
+      copies.forEach(
+        function(copy, index) {
+          var source = sources[index];
+          if (length === 0) {
+            Assert(copy.compare(source, offset, end, offset, end) === 0);
+            return;
+          }
+          if (
+            source.compare(
+              sources[leader],
+              offset + vectorOffset,
+              offset + vectorOffset + Quorum.ID,
+              offset + vectorOffset,
+              offset + vectorOffset + Quorum.ID
+            ) !== 0
+          ) {
+            source = sources[leader];
+            expect++;
+          }
+          Assert(copy.compare(source, offset, end, offset, end) === 0);
+        }
+      );
+      Assert(repaired[object] === expect);
+    }
+  }
+  function copy() {
+    return sources.map(
+      function(source) {
+        return Buffer.from(source);
+      }
+    );
+  }
+  var copies = copy();
+  var quorumRepair = Buffer.alloc(objects * Quorum.SIZE);
+  var targetRepair = Buffer.alloc(sourceSize);
+  var repaired = Quorum.repair(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    copies,
+    quorumRepair,
+    0,
+    targetRepair,
+    0
+  );
+  verify(copies, quorumRepair, targetRepair, repaired);
+  // A second repair finds nothing left to rewrite, except where forked:
+  var again = Quorum.repair(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    copies,
+    null,
+    0,
+    null,
+    0
+  );
+  for (var object = 0; object < objects; object++) {
+    if (quorum[object * Quorum.SIZE + Quorum.LENGTH_OFFSET] === 0) continue;
+    Assert(again[object] === 0);
+  }
+  var copiesAsync = copy();
+  var quorumAsync = Buffer.alloc(objects * Quorum.SIZE);
+  var targetAsync = Buffer.alloc(sourceSize);
+  Quorum.repair(
+    vectorOffset,
+    objectSize,
+    0,
+    sourceSize,
+    copiesAsync,
+    quorumAsync,
+    0,
+    targetAsync,
+    0,
+    { threads: 2 },
+    function(error, repaired) {
+      if (error) throw error;
+      verify(copiesAsync, quorumAsync, targetAsync, repaired);
+    }
+  );
+})();
+
+// Test calculate() and repair() with segmented sources and target:
+(function() {
+  var objects = 64;
+  var objectSize = Quorum.VECTOR + 8;
+  var vectorOffset = 4;
+  var sourceOffset = objectSize * 2;
+  var sourceSize = objects * objectSize;
+  var sources = Generate.sources(
+    vectorOffset,
+    objectSize,
+    sourceOffset,
+    sourceSize,
+    5
+  );
+  // Slice a copy of a buffer at random, not always on an object boundary,
+  // and with some empty segments:
+  function segment(buffer) {
+    var copy = Buffer.from(buffer);
+    var segments = [];
+    var offset = 0;
+    while (offset < copy.length) {
+      var length = Math.floor(Random() * objectSize * 4);
+      if (Random() < 0.5) length -= length % objectSize;
+      length = Math.min(length, copy.length - offset);
+      segments.push(copy.slice(offset, offset + length));
+      offset += length;
+    }
+    return segments;
+  }
+  function flatten(list) {
+    return Array.isArray(list) ? Buffer.concat(list) : list;
+  }
+  var quorum = Buffer.alloc(objects * Quorum.SIZE);
+  var target = Buffer.alloc(objectSize + sourceSize);
+  Quorum.calculate(
+    vectorOffset,
+    objectSize,
+    sourceOffset,
+    sourceSize,
+    sources,
+    quorum,
+    0,
+    target,
+    objectSize
+  );
+  var repairedCopies = sources.map(
+    function(source) {
+      return Buffer.from(source);
+    }
+  );
+  var repaired = Quorum.repair(
+    vectorOffset,
+    objectSize,
+    sourceOffset,
+    sourceSize,
+    repairedCopies,
+    null,
+    0,
+    null,
+    0
+  );
+  for (var test = 0; test < 8; test++) {
+    // Mix segmented and contiguous sources:
+    var segmented = sources.map(
+      function(source, index) {
+        return index % 2 === test % 2 ? segment(source) : Buffer.from(source);
+      }
+    );
+    var quorumSegmented = Buffer.alloc(objects * Quorum.SIZE);
+    var targetSegmented = segment(Buffer.alloc(objectSize + sourceSize));
+    Quorum.calculate(
+      vectorOffset,
+      objectSize,
+      sourceOffset,
+      sourceSize,
+      segmented,
+      quorumSegmented,
+      0,
+      targetSegmented,
+      objectSize
+    );
+    Assert(quorumSegmented.equals(quorum));
+    Assert(flatten(targetSegmented).equals(target));
+    // Repair writes through to the segments, even where objects straddle:
+    var repairedSegmented = Quorum.repair(
+      vectorOffset,
+      objectSize,
+      sourceOffset,
+      sourceSize,
+      segmented,
+      null,
+      0,
+      null,
+      0
+    );
+    Assert(repairedSegmented.equals(repaired));
+    segmented.forEach(
+      function(source, index) {
+        Assert(flatten(source).equals(repairedCopies[index]));
+      }
+    );
+  }
+  // Asynchronously, across threads and chunks:
+  var segmentedAsync = sources.map(segment);
+  var quorumAsync = Buffer.alloc(objects * Quorum.SIZE);
+  var targetAsync = segment(Buffer.alloc(objectSize + sourceSize));
+  Quorum.calculate(
+    vectorOffset,
+    objectSize,
+    sourceOffset,
+    sourceSize,
+    segmentedAsync,
+    quorumAsync,
+    0,
+    targetAsync,
+    objectSize,
+    { threads: 2, chunk: 7 },
+    function(error) {
+      if (error) throw error;
+      Assert(quorumAsync.equals(quorum));
+      Assert(flatten(targetAsync).equals(target));
+    }
+  );
+  // Segments must add up to the same length for every source:
+  var short = sources.map(segment);
+  short[1] = short[1].concat([Buffer.alloc(1)]);
+  Assert.throws(
+    function() {
+      Quorum.calculate(
+        vectorOffset,
+        objectSize,
+        sourceOffset,
+        sourceSize,
+        short,
+        null,
+        0,
+        null,
+        0
+      );
+    },
+    /sources must have the same length/
+  );
+  // calculateBatch() and ReplicaSet need contiguous sources:
+  Assert.throws(
+    function() {
+      new Quorum.ReplicaSet(sources.map(segment));
+    },
+    /sources must be an array of buffers/
+  );
+})();
+
+// Test calculateBatch():
+(function() {
+  var objectSize = Quorum.VECTOR + 16;
+  var vectorOffset = 8;
+  var sourceObjects = 2048 + 5;
+  var sourceSize = sourceObjects * objectSize;
+  var sources = Generate.sources(vectorOffset, objectSize, 0, sourceSize, 5);
+  // Extents may be in any order, and may refer to the same source objects:
+  var tuples = [];
+  var objects = 0;
+  var targetSize = 0;
+  while (tuples.length < 64) {
+    // The first extent is long enough to be spread across threads:
+    var length = tuples.length === 0 ? 2048 : Generate.choose(1, 16);
+    var first = Generate.choose(0, sourceObjects - length);
+    tuples.push([
+      first * objectSize,
+      length * objectSize,
+      objects * Quorum.SIZE,
+      targetSize
+    ]);
+    objects += length;
+    targetSize += length * objectSize;
+  }
+  var extents = Generate.extents(tuples);
+  var quorumExpect = Buffer.alloc(objects * Quorum.SIZE);
+  var targetExpect = Buffer.alloc(targetSize);
+  tuples.forEach(
+    function(tuple) {
+      Quorum.calculate(
+        vectorOffset,
+        objectSize,
+        tuple[0],
+        tuple[1],
+        sources,
+        quorumExpect,
+        tuple[2],
+        targetExpect,
+        tuple[3]
+      );
+    }
+  );
+  function leaders(quorum) {
+    var leaders = Buffer.alloc(objects);
+    for (var index = 0; index < objects; index++) {
+      var offset = index * Quorum.SIZE;
+      leaders[index] = quorum[offset + Quorum.LENGTH_OFFSET] === 0 ?
+        Quorum.LEADER_NONE : quorum[offset + Quorum.LEADER_OFFSET];
+    }
+    return leaders;
+  }
+  [1, 2, Quorum.THREADS_MAX].forEach(
+    function(threads) {
+      var quorum = Buffer.alloc(objects * Quorum.SIZE);
+      var target = Buffer.alloc(targetSize);
+      var options = {
+        threads: threads,
+        stream: threads === 2,
+        leaders: Buffer.alloc(objects)
+      };
+      Quorum.calculateBatch(
+        vectorOffset,
+        objectSize,
+        sources,
+        extents,
+        quorum,
+        target,
+        options
+      );
+      Assert(quorum.equals(quorumExpect));
+      Assert(target.equals(targetExpect));
+      Assert(options.leaders.equals(leaders(quorumExpect)));
+    }
+  );
+  var quorum = Buffer.alloc(objects * Quorum.SIZE);
+  Quorum.calculateBatch(
+    vectorOffset,
+    objectSize,
+    sources,
+    extents,
+    quorum,
+    null,
+    function(error) {
+      if (error) throw error;
+      Assert(quorum.equals(quorumExpect));
+    }
+  );
+  // The caller may reuse the extents as soon as calculateBatch() returns:
+  extents.fill(255);
+})();
+
+// Test ReplicaSet:
+(function() {
+  function throws(method, message) {
+    try {
+      method();
+    } catch (exception) {
+      var error = exception.message;
+    }
+    if (error !== message) {
+      throw new Error('Expected exception: ' + JSON.stringify(message));
+    }
+  }
+  throws(
+    function() { Quorum.ReplicaSet([Buffer.alloc(Quorum.VECTOR)]); },
+    'ReplicaSet must be called with new'
+  );
+  throws(
+    function() { new Quorum.ReplicaSet({}); },
+    'sources must be an array'
+  );
+  throws(
+    function() { new Quorum.ReplicaSet([]); },
+    'sources.length must be at least SOURCES_MIN'
+  );
+  throws(
+    function() {
+      new Quorum.ReplicaSet([Buffer.alloc(1), Buffer.alloc(2)]);
+    },
+    'sources must have the same length'
+  );
+  // Each source is read once, and the buffer read is the one pinned:
+  (function() {
+    var reads = 0;
+    var source = Crypto.randomBytes(Quorum.VECTOR);
+    var array = [source];
+    Object.defineProperty(array, 1, {
+      enumerable: true,
+      get: function() {
+        reads++;
+        return reads === 1 ? source : Buffer.alloc(1);
+      }
+    });
+    var replicaSet = new Quorum.ReplicaSet(array);
+    Assert(reads === 1);
+    var quorum = Buffer.alloc(Quorum.SIZE);
+    replicaSet.calculate(
+      0,
+      Quorum.VECTOR,
+      0,
+      Quorum.VECTOR,
+      quorum,
+      0,
+      null,
+      0
+    );
+    Assert(reads === 1);
+  })();
+  var objects = 128;
+  var objectSize = Quorum.VECTOR;
+  var sourceSize = objects * objectSize;
+  var sources = Generate.sources(0, objectSize, 0, sourceSize, 65);
+  var replicaSet = new Quorum.ReplicaSet(sources);
+  // The replica set pins its own copy of the array:
+  var copies = sources.slice(0);
+  sources.length = 0;
+  throws(
+    function() { replicaSet.calculate(0, objectSize, 0, sourceSize, null, 0); },
+    'arguments.length must be at least 8'
+  );
+  throws(
+    function() {
+      replicaSet.calculate(0, objectSize, 0, sourceSize * 2, null, 0, null, 0);
+    },
+    'source.length must be at least sourceOffset + sourceSize'
+  );
+  var quorumExpect = Buffer.alloc(objects * Quorum.SIZE);
+  var targetExpect = Buffer.alloc(sourceSize);
+  Quorum.calculate(
+    0,
+    objectSize,
+    0,
+    sourceSize,
+    copies,
+    quorumExpect,
+    0,
+    targetExpect,
+    0
+  );
+  var quorum = Buffer.alloc(objects * Quorum.SIZE);
+  var target = Buffer.alloc(sourceSize);
+  replicaSet.calculate(0, objectSize, 0, sourceSize, quorum, 0, target, 0);
+  Assert(quorum.equals(quorumExpect));
+  Assert(target.equals(targetExpect));
+  var quorumBatch = Buffer.alloc(objects * Quorum.SIZE);
+  replicaSet.calculateBatch(
+    0,
+    objectSize,
+    Generate.extents([[0, sourceSize, 0, 0]]),
+    quorumBatch,
+    null,
+    { threads: 2 }
+  );
+  Assert(quorumBatch.equals(quorumExpect));
+  var quorumAsync = Buffer.alloc(objects * Quorum.SIZE);
+  replicaSet.calculate(
+    0,
+    objectSize,
+    0,
+    sourceSize,
+    quorumAsync,
+    0,
+    null,
+    0,
+    function(error) {
+      if (error) throw error;
+      Assert(quorumAsync.equals(quorumExpect));
+      // Repair last, since it rewrites the sources:
+      replicaSet.repair(
+        0,
+        objectSize,
+        0,
+        sourceSize,
+        null,
+        0,
+        null,
+        0,
+        {},
+        function(error, repaired) {
+          if (error) throw error;
+          Assert(repaired.length === objects);
+          for (var index = 0; index < objects; index++) {
+            if (quorumExpect[index * Quorum.SIZE + Quorum.LENGTH_OFFSET]) {
+              var offset = index * objectSize;
+              copies.forEach(
+                function(copy) {
+                  Assert(
+                    copy.compare(
+                      targetExpect,
+                      offset,
+                      offset + Quorum.ID,
+                      offset,
+                      offset + Quorum.ID
+                    ) === 0
+                  );
+                }
+              );
+            }
+          }
+        }
+      );
+    }
+  );
+})();
+
+// Test calculateFiles():
+(function() {
+  var objects = 300;
+  var objectSize = Quorum.VECTOR + 4;
+  var vectorOffset = 2;
+  var sourceOffset = 7;
+  var sourceSize = objects * objectSize;
+  var sources = Generate.sources(
+    vectorOffset,
+    objectSize,
+    sourceOffset,
+    sourceSize,
+    7
+  );
+  var directory = FS.mkdtempSync(Path.join(OS.tmpdir(), 'quorum-'));
+  var paths = sources.map(
+    function(source, index) {
+      var path = Path.join(directory, String(index));
+      FS.writeFileSync(path, source);
+      return path;
+    }
+  );
+  var fds = paths.map(
+    function(path) {
+      return FS.openSync(path, 'r');
+    }
+  );
+  function cleanup() {
+    fds.forEach(FS.closeSync);
+    paths.forEach(FS.unlinkSync);
+    FS.rmdirSync(directory);
+  }
+  var quorumExpect = Buffer.alloc(objects * Quorum.SIZE);
+  var targetExpect = Buffer.alloc(sourceSize);
+  Quorum.calculate(
+    vectorOffset,
+    objectSize,
+    sourceOffset,
+    sourceSize,
+    sources,
+    quorumExpect,
+    0,
+    targetExpect,
+    0
+  );
+  function calculate(options, callback) {
+    var quorum = Buffer.alloc(objects * Quorum.SIZE);
+    var target = Buffer.alloc(sourceSize);
+    var args = [
+      vectorOffset,
+      objectSize,
+      sourceOffset,
+      sourceSize,
+      fds,
+      quorum,
+      0,
+      target,
+      0,
+      options
+    ];
+    if (!callback) {
+      Quorum.calculateFiles(...args);
+      Assert(quorum.equals(quorumExpect));
+      Assert(target.equals(targetExpect));
+      return;
+    }
+    args.push(
+      function(error) {
+        if (error) return callback(error);
+        Assert(quorum.equals(quorumExpect));
+        Assert(target.equals(targetExpect));
+        callback();
+      }
+    );
+    Quorum.calculateFiles(...args);
+  }
+  calculate({});
+  // A window which is not a multiple of objectSize reads whole objects:
+  calculate({ window: objectSize * 7 + 3 });
+  calculate({ window: objectSize });
+  calculate({ window: objectSize * 3, stream: true });
+  var leaders = Buffer.alloc(objects);
+  calculate({ window: objectSize * 16, leaders: leaders });
+  for (var index = 0; index < objects; index++) {
+    var offset = index * Quorum.SIZE;
+    if (quorumExpect[offset + Quorum.LENGTH_OFFSET] === 0) continue;
+    Assert(leaders[index] === quorumExpect[offset + Quorum.LEADER_OFFSET]);
+  }
+  var exceptions = [
+    [{ fds: {} }, 'fds must be an array'],
+    [{ fds: [] }, 'fds.length must be at least SOURCES_MIN'],
+    [{ fds: ['0'] }, 'fds must be an array of file descriptors'],
+    [{ fds: [-1] }, 'fds must be an array of file descriptors'],
+    [
+      { options: { window: objectSize - 1 } },
+      'options.window must be at least objectSize'
+    ],
+    [
+      { options: { window: Quorum.WINDOW_MAX + 1 } },
+      'options.window must be at most WINDOW_MAX'
+    ],
+    [{ options: { depth: 0 } }, 'options.depth must be at least 1'],
+    [
+      { options: { depth: Quorum.DEPTH_MAX + 1 } },
+      'options.depth must be at most DEPTH_MAX'
+    ]
+  ];
+  exceptions.forEach(
+    function(exception) {
+      try {
+        Quorum.calculateFiles(
+          vectorOffset,
+          objectSize,
+          sourceOffset,
+          sourceSize,
+          exception[0].fds || fds,
+          null,
+          0,
+          null,
+          0,
+          exception[0].options || {}
+        );
+      } catch (error) {
+        var message = error.message;
+      }
+      Assert(message === exception[1]);
+    }
+  );
+  // Reading beyond the end of a file fails with the libuv error code:
+  try {
+    Quorum.calculateFiles(
+      vectorOffset,
+      objectSize,
+      sourceOffset + objectSize * 1000,
+      sourceSize,
+      fds,
+      null,
+      0,
+      null,
+      0
+    );
+  } catch (error) {
+    var code = error.code;
+  }
+  Assert(code === 'EOF');
+  // Windows of reads in flight through io_uring, or the pread() fallback:
+  [1, 3, Quorum.DEPTH_MAX].forEach(
+    function(depth) {
+      calculate({ window: objectSize * 7, depth: depth });
+      calculate({ window: objectSize * 7, depth: depth, uring: false });
+    }
+  );
+  [true, false].forEach(
+    function(uring) {
+      try {
+        Quorum.calculateFiles(
+          vectorOffset,
+          objectSize,
+          sourceOffset + objectSize * 1000,
+          sourceSize,
+          fds,
+          null,
+          0,
+          null,
+          0,
+          { uring: uring }
+        );
+      } catch (error) {
+        var code = error.code;
+      }
+      Assert(code === 'EOF');
+    }
+  );
+  // A file which ends within an object fails after a short read:
+  var short = Path.join(directory, 'short');
+  FS.writeFileSync(
+    short,
+    sources[0].slice(0, sourceOffset + objectSize * 2 + 10)
+  );
+  var shortFd = FS.openSync(short, 'r');
+  [true, false].forEach(
+    function(uring) {
+      try {
+        var code = undefined;
+        Quorum.calculateFiles(
+          vectorOffset,
+          objectSize,
+          sourceOffset,
+          objectSize * 4,
+          [shortFd],
+          null,
+          0,
+          null,
+          0,
+          { uring: uring, depth: 1 }
+        );
+      } catch (error) {
+        code = error.code;
+      }
+      Assert(code === 'EOF');
+    }
+  );
+  FS.closeSync(shortFd);
+  FS.unlinkSync(short);
+  // repairFiles() writes back the objects rewritten by repair, as repair()
+  // does in memory, and fails on files which are not writable:
+  var copies = sources.map(
+    function(source) {
+      return Buffer.from(source);
+    }
+  );
+  var repairedExpect = Quorum.repair(
+    vectorOffset,
+    objectSize,
+    sourceOffset,
+    sourceSize,
+    copies,
+    null,
+    0,
+    null,
+    0
+  );
+  Assert(
+    repairedExpect.some(
+      function(repaired) {
+        return repaired > 0;
+      }
+    )
+  );
+  [true, false].forEach(
+    function(uring) {
+      var writable = paths.map(
+        function(path, index) {
+          FS.writeFileSync(path, sources[index]);
+          return FS.openSync(path, 'r+');
+        }
+      );
+      var repaired = Quorum.repairFiles(
+        vectorOffset,
+        objectSize,
+        sourceOffset,
+        sourceSize,
+        writable,
+        null,
+        0,
+        null,
+        0,
+        { window: objectSize * 5, depth: 4, uring: uring }
+      );
+      writable.forEach(FS.closeSync);
+      Assert(repaired.equals(repairedExpect));
+      paths.forEach(
+        function(path, index) {
+          Assert(FS.readFileSync(path).equals(copies[index]));
+          FS.writeFileSync(path, sources[index]);
+        }
+      );
+      try {
+        Quorum.repairFiles(
+          vectorOffset,
+          objectSize,
+          sourceOffset,
+          sourceSize,
+          fds,
+          null,
+          0,
+          null,
+          0,
+          { uring: uring }
+        );
+      } catch (error) {
+        var code = error.code;
+      }
+      Assert(code === 'EBADF');
+    }
+  );
+  calculate(
+    { window: objectSize * 5, depth: 2, threads: 2 },
+    function(error) {
+      if (error) throw error;
+      cleanup();
+    }
+  );
+})();
+
+// Test every engine and every kernel against the reference:
+(function() {
+  Fuzz.run(Fuzz.ITERATIONS);
+  ['sse2,scalar', 'scalar ', 'SCALAR', '', 'native-scalar'].forEach(
+    function(kernel) {
+      Assert.throws(
+        function() {
+          Quorum._setKernel(kernel);
+        },
+        /^Error: kernel must be native, scalar, sse2 or generic$/
+      );
+    }
+  );
+  // The kernels are read by other threads once any method has run:
+  ['native', 'scalar', 'generic'].forEach(
+    function(kernel) {
+      Assert.throws(
+        function() {
+          Quorum._setKernel(kernel);
+        },
+        /^Error: kernel must be selected before any calculation$/
+      );
+    }
+  );
+  var kernels = ['scalar', 'generic'];
+  if (process.arch === 'x64' || process.arch === 'ia32') kernels.push('sse2');
+  kernels.forEach(
+    function(kernel) {
+      var child = ChildProcess.spawnSync(
+        process.execPath,
+        [__filename, '--fuzz', kernel],
+        { stdio: 'inherit' }
+      );
+      Assert(child.status === 0, 'kernel ' + kernel);
+    }
+  );
+})();
+
+// Test calculate():
+var queue = new Queue(8);
+queue.onData = function(test, end) {
+  var args = Generate.args();
+  function execute(...parameters) {
+    if (Random() < 0.5) {
+      var options = { threads: Generate.choose(1, Quorum.THREADS_MAX) };
+      if (Random() < 0.5) options.stream = true;
+      if (Random() < 0.5) options.members = args.members;
+      if (Random() < 0.5) options.lagging = args.lagging;
+      parameters.splice(parameters.length - 1, 0, options);
+    }
+    if (!options || !options.members) args.members = null;
+    if (!options || !options.lagging) args.lagging = null;
     if (Random() < 0.8) {
       Quorum.calculate.apply(Quorum, parameters); // Async
     } else {
@@ -722,6 +3825,8 @@ queue.onData = function(test, end) {
         args.targetSuffix
       );
       Assert(args.target.equals(args.targetReference));
+      if (args.members) Assert(args.members.equals(args.membersReference));
+      if (args.lagging) Assert(args.lagging.equals(args.laggingReference));
       end();
     }
   );